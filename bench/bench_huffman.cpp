@@ -0,0 +1,387 @@
+#include "adaptive.h"
+#include "batch.h"
+#include "bwt.h"
+#include "code_table.h"
+#include "file_pipeline.h"
+#include "histogram.h"
+#include "huffman.h"
+#include "multi_table.h"
+#include "run_length.h"
+#include "static_code.h"
+#include "stream.h"
+#include "table_decoder.h"
+#include "transform.h"
+
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kCorpusSize = 64 * 1024 * 1024;
+
+// Keeps benchmarked results observable so the work is not optimized away
+volatile std::uint64_t benchSink = 0;
+
+[[nodiscard]] std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Repeats `seed` until the corpus reaches kCorpusSize bytes
+[[nodiscard]] std::string makeCorpus(const std::string& seed) {
+    std::string corpus;
+    corpus.reserve(kCorpusSize + seed.size());
+    while (corpus.size() < kCorpusSize) {
+        corpus += seed;
+    }
+    return corpus;
+}
+
+// Runs `fn` `iterations` times and reports throughput over `bytes` per run
+template <typename Fn>
+void report(const std::string& name, std::size_t bytes, int iterations, Fn&& fn) {
+    fn();  // Warm up
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double mbPerSec = static_cast<double>(bytes) * iterations / elapsed.count() / 1e6;
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << mbPerSec << " MB/s\n";
+}
+
+void benchHistogram(const std::string& corpus) {
+    std::cout << "Histogram (" << corpus.size() << " bytes):\n";
+    for (auto kernel : {huffman::HistogramKernel::Scalar, huffman::HistogramKernel::Sse4,
+                        huffman::HistogramKernel::Avx2}) {
+        if (!huffman::isKernelSupported(kernel)) continue;
+        report(huffman::kernelName(kernel), corpus.size(), 5, [&] {
+            benchSink = benchSink + huffman::computeHistogram(corpus, kernel)[' '];
+        });
+    }
+    for (unsigned threads : {2u, 4u, 8u}) {
+        report("parallel, " + std::to_string(threads) + " threads", corpus.size(), 5, [&] {
+            benchSink = benchSink + huffman::computeHistogramParallel(corpus, threads)[' '];
+        });
+    }
+    std::cout << "  (dispatch selects " << huffman::kernelName(huffman::detectHistogramKernel())
+              << ")\n";
+
+    // Size estimates versus the actual order-0 encode they predict
+    std::uint64_t full = 0;
+    std::uint64_t sampled = 0;
+    report("estimate (full histogram)", corpus.size(), 5, [&] {
+        full = huffman::estimateCompressedSize(huffman::computeHistogram(corpus));
+    });
+    report("estimate (64K sample)", corpus.size(), 5, [&] {
+        sampled = huffman::estimateCompressedSize(std::string_view(corpus));
+    });
+    std::cout << "  estimated " << full << " bytes, sampled " << sampled << " bytes\n\n";
+}
+
+// Many small trees, as when every message gets its own table
+void benchTreeBuild(const std::string& corpus) {
+    constexpr std::size_t kMessage = 4096;
+    constexpr std::size_t kMessages = 4096;
+    std::cout << "Tree rebuild (" << kMessages << " x " << kMessage << " byte messages):\n";
+
+    huffman::HuffmanTree tree;
+    report("reused tree", kMessage * kMessages, 3, [&] {
+        for (std::size_t i = 0; i < kMessages; ++i) {
+            tree.buildTree(std::string_view(corpus).substr(i * kMessage, kMessage));
+            benchSink = benchSink + tree.getCodes()['e'].length;
+        }
+    });
+    std::pmr::unsynchronized_pool_resource pool;
+    report("fresh tree, pooled resource", kMessage * kMessages, 3, [&] {
+        for (std::size_t i = 0; i < kMessages; ++i) {
+            huffman::HuffmanTree local(&pool);
+            local.buildTree(std::string_view(corpus).substr(i * kMessage, kMessage));
+            benchSink = benchSink + local.getCodes()['e'].length;
+        }
+    });
+    std::cout << '\n';
+}
+
+void benchDecode(const std::string& corpus) {
+    huffman::HuffmanTree tree;
+    tree.buildTree(corpus);
+    const auto table = huffman::CodeTable::fromTree(tree);
+    const auto packed = table.encode(corpus);
+
+    std::cout << "Decode (" << corpus.size() << " bytes):\n";
+    for (unsigned symbols : {1u, 4u}) {
+        const huffman::TableDecoder decoder(table, {11, symbols});
+        for (auto kernel : {huffman::DecodeKernel::Generic, huffman::DecodeKernel::Bmi2}) {
+            if (!huffman::isKernelSupported(kernel)) continue;
+            const std::string name = std::string(huffman::kernelName(kernel)) + ", " +
+                                     std::to_string(symbols) + " sym/lookup";
+            report(name, corpus.size(), 5, [&] {
+                benchSink = benchSink + decoder.decode(packed.bytes, packed.bitCount,
+                                                       packed.symbolCount, kernel).size();
+            });
+        }
+    }
+    std::cout << '\n';
+}
+
+// Fixed header-text code built at compile time vs the same code at runtime
+void benchStaticCode(const std::string& corpus) {
+    const std::string sample = corpus.substr(0, 16 * 1024 * 1024);
+    const auto& code = huffman::kHeaderTextCode;
+    const auto packed = code.encode(sample);
+
+    std::cout << "Static header-text code (" << sample.size() << " bytes, ratio "
+              << std::setprecision(3)
+              << static_cast<double>(packed.bitCount) / static_cast<double>(8 * sample.size())
+              << "):\n";
+    report("constexpr table decode", sample.size(), 5, [&] {
+        benchSink = benchSink + code.decode(packed).size();
+    });
+    const huffman::TableDecoder decoder(code.toCodeTable(), {10, 1});
+    report("runtime table decode", sample.size(), 5, [&] {
+        benchSink = benchSink + decoder.decode(packed).size();
+    });
+    std::cout << '\n';
+}
+
+// Thousands of sub-1KB messages: per-message streams vs one shared table
+void benchBatch(const std::string& corpus) {
+    constexpr std::size_t kMessages = 16384;
+    std::mt19937 rng(9);
+    std::vector<std::string_view> messages;
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        const std::size_t size = 64 + rng() % 900;
+        messages.push_back(std::string_view(corpus).substr(i * 1024, size));
+        total += size;
+    }
+    std::cout << "Batch (" << kMessages << " messages, " << total << " bytes):\n";
+
+    const huffman::StreamEncoder streamEncoder;
+    report("per-message stream encode", total, 2, [&] {
+        for (std::string_view message : messages) {
+            benchSink = benchSink + streamEncoder.encode(message).size();
+        }
+    });
+
+    const huffman::BatchEncoder encoder(huffman::BatchEncoder::train(messages));
+    huffman::EncodedBatch batch;
+    report("batch encode", total, 5, [&] { batch = encoder.encode(messages); });
+    const huffman::BatchDecoder decoder(encoder.table());
+    report("batch decode", total, 5, [&] {
+        benchSink = benchSink + decoder.decode(batch).data.size();
+    });
+    std::cout << '\n';
+}
+
+// Whole-file compression: read, encode and write one after another versus
+// the overlapped pipeline on each I/O backend
+void benchFileCompress(const std::string& corpus) {
+    const std::string input = "/tmp/huffman_bench_input";
+    const std::string output = "/tmp/huffman_bench_output";
+    {
+        std::ofstream file(input, std::ios::binary);
+        file.write(corpus.data(), static_cast<std::streamsize>(corpus.size()));
+    }
+
+    std::cout << "File compress (" << corpus.size() << " bytes, page cache):\n";
+    const huffman::StreamEncoder encoder;
+    report("read + encode + write", corpus.size(), 2, [&] {
+        const std::string stream = encoder.encode(readFile(input));
+        std::ofstream file(output, std::ios::binary);
+        file.write(stream.data(), static_cast<std::streamsize>(stream.size()));
+    });
+    for (huffman::IoBackend backend : {huffman::IoBackend::Threads, huffman::IoBackend::IoUring}) {
+        if (backend == huffman::IoBackend::IoUring && !huffman::isIoUringAvailable()) continue;
+        huffman::FileCompressOptions options;
+        options.backend = backend;
+        report(std::string("pipeline, ") + huffman::backendName(backend), corpus.size(), 3, [&] {
+            benchSink = benchSink + huffman::compressFile(input, output, options).bytesOut;
+        });
+    }
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    std::cout << '\n';
+}
+
+void benchStreamDecode(const std::string& corpus) {
+    // One block, so any parallelism comes from the sync-point index
+    const std::string stream = huffman::StreamEncoder({corpus.size(), 1 << 20}).encode(corpus);
+
+    std::cout << "Stream decode, single block with sync points:\n";
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        const huffman::StreamDecoder decoder(threads);
+        report(std::to_string(threads) + " threads", corpus.size(), 3, [&] {
+            benchSink = benchSink + decoder.decode(stream).size();
+        });
+    }
+
+    // Incompressible input falls back to stored blocks on both ends
+    std::mt19937_64 rng(1);
+    std::string random(16 * 1024 * 1024, '\0');
+    for (std::size_t i = 0; i + 8 <= random.size(); i += 8) {
+        const std::uint64_t bits = rng();
+        std::memcpy(random.data() + i, &bits, 8);
+    }
+    const huffman::StreamEncoder encoder;
+    std::string stored;
+    report("random encode (stored)", random.size(), 2, [&] { stored = encoder.encode(random); });
+    report("random decode (stored)", random.size(), 3, [&] {
+        benchSink = benchSink + huffman::StreamDecoder(1).decode(stored).size();
+    });
+    std::cout << '\n';
+}
+
+// One-pass adaptive coding versus the two-pass block-static stream
+void benchAdaptive(const std::string& corpus) {
+    const std::string sample = corpus.substr(0, 8 * 1024 * 1024);
+    std::cout << "Adaptive vs block-static (" << sample.size() << " bytes):\n";
+
+    std::size_t adaptiveBytes = 0;
+    huffman::PackedBits packed;
+    report("adaptive encode", sample.size(), 2, [&] {
+        huffman::AdaptiveHuffmanEncoder encoder;
+        encoder.encode(sample);
+        packed = encoder.finish();
+        adaptiveBytes = packed.bytes.size();
+    });
+    report("adaptive decode", sample.size(), 2, [&] {
+        benchSink = benchSink + huffman::AdaptiveHuffmanDecoder().decode(packed).size();
+    });
+
+    const huffman::StreamEncoder encoder({64 * 1024, 0});
+    std::string stream;
+    report("block-static encode (64K)", sample.size(), 2, [&] { stream = encoder.encode(sample); });
+    report("block-static decode (64K)", sample.size(), 2, [&] {
+        benchSink = benchSink + huffman::StreamDecoder(1).decode(stream).size();
+    });
+
+    std::cout << "  ratio: adaptive " << std::setprecision(3)
+              << static_cast<double>(adaptiveBytes) / static_cast<double>(sample.size())
+              << ", block-static "
+              << static_cast<double>(stream.size()) / static_cast<double>(sample.size()) << "\n\n";
+}
+
+void benchContext(const std::string& corpus) {
+    const std::string sample = corpus.substr(0, 8 * 1024 * 1024);
+    std::cout << "Order-1 context blocks (" << sample.size() << " bytes, 1M blocks):\n";
+
+    for (unsigned tables : {0u, 4u, 16u, 64u}) {
+        huffman::StreamOptions options;
+        options.contextTables = tables;
+        const huffman::StreamEncoder encoder(options);
+        std::string stream;
+        const std::string label = "context tables " + std::to_string(tables);
+        report(label + " encode", sample.size(), 2, [&] { stream = encoder.encode(sample); });
+        report(label + " decode", sample.size(), 2, [&] {
+            benchSink = benchSink + huffman::StreamDecoder(1).decode(stream).size();
+        });
+        std::cout << "  ratio: " << std::setprecision(3)
+                  << static_cast<double>(stream.size()) / static_cast<double>(sample.size())
+                  << '\n';
+    }
+    std::cout << '\n';
+}
+
+void benchLz77(const std::string& corpus) {
+    const std::string sample = corpus.substr(0, 8 * 1024 * 1024);
+    std::cout << "LZ77 blocks (" << sample.size() << " bytes, 1M blocks):\n";
+
+    for (unsigned level : {1u, 6u, 9u}) {
+        huffman::StreamOptions options;
+        options.lz77Level = level;
+        const huffman::StreamEncoder encoder(options);
+        std::string stream;
+        const std::string label = "lz77 level " + std::to_string(level);
+        report(label + " encode", sample.size(), 2, [&] { stream = encoder.encode(sample); });
+        report(label + " decode", sample.size(), 2, [&] {
+            benchSink = benchSink + huffman::StreamDecoder(1).decode(stream).size();
+        });
+        std::cout << "  ratio: " << std::setprecision(3)
+                  << static_cast<double>(stream.size()) / static_cast<double>(sample.size())
+                  << '\n';
+    }
+    std::cout << '\n';
+}
+
+void benchBwt(const std::string& corpus) {
+    const std::string sample = corpus.substr(0, 4 * 1024 * 1024);
+    const std::string block = sample.substr(0, 1024 * 1024);
+    std::cout << "BWT pipeline stages (1M block):\n";
+
+    report("suffix array (SA-IS)", block.size(), 2, [&] {
+        benchSink = benchSink + huffman::buildSuffixArray(block).size();
+    });
+    const huffman::BwtBlock bwt = huffman::bwtForward(block);
+    report("inverse bwt", block.size(), 2, [&] {
+        benchSink = benchSink + huffman::bwtInverse(bwt.data, bwt.primaryIndex).size();
+    });
+    std::string mtf;
+    report("move-to-front", block.size(), 2, [&] { mtf = huffman::moveToFront(bwt.data); });
+    std::vector<std::uint16_t> tokens;
+    report("zero-run tokens", block.size(), 2, [&] { tokens = huffman::zeroRunTokens(mtf); });
+    report("multi-table build", block.size(), 2, [&] {
+        benchSink = benchSink + huffman::MultiTableModel::build(tokens, 258).encodedBits();
+    });
+
+    huffman::StreamOptions options;
+    options.bwt = true;
+    const huffman::StreamEncoder encoder(options);
+    std::string stream;
+    report("bwt stream encode", sample.size(), 1, [&] { stream = encoder.encode(sample); });
+    report("bwt stream decode", sample.size(), 1, [&] {
+        benchSink = benchSink + huffman::StreamDecoder(1).decode(stream).size();
+    });
+    std::cout << "  ratio: " << std::setprecision(3)
+              << static_cast<double>(stream.size()) / static_cast<double>(sample.size()) << "\n\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string seed;
+    try {
+        seed = readFile(argc > 1 ? argv[1] : "test_input.txt");
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    if (seed.empty()) {
+        std::cerr << "Error: corpus is empty\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::string corpus = makeCorpus(seed);
+
+    std::cout << "=== Huffman Benchmarks ===\n\n";
+    benchHistogram(corpus);
+    benchTreeBuild(corpus);
+    benchDecode(corpus);
+    benchStaticCode(corpus);
+    benchBatch(corpus);
+    benchStreamDecode(corpus);
+    benchFileCompress(corpus);
+    benchAdaptive(corpus);
+    benchContext(corpus);
+    benchLz77(corpus);
+    benchBwt(corpus);
+
+    return EXIT_SUCCESS;
+}
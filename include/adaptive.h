@@ -0,0 +1,86 @@
+#ifndef HUFFMAN_ADAPTIVE_H
+#define HUFFMAN_ADAPTIVE_H
+
+#include "bitstream.h"
+#include "code_table.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// One-pass adaptive Huffman tree (FGK algorithm). Encoder and decoder start
+// from the same empty tree and update it identically after every symbol, so
+// no frequency pass and no code table are needed. A symbol's first
+// occurrence is sent as the code of the NYT ("not yet transmitted") leaf
+// followed by its 8 raw bits.
+class AdaptiveHuffmanTree {
+public:
+    AdaptiveHuffmanTree();
+
+    // Writes the current code of `symbol`, then updates the tree.
+    void encodeSymbol(unsigned char symbol, BitWriter& writer);
+    // Reads one symbol, then updates the tree. Throws std::runtime_error if
+    // the stream ends mid-code.
+    [[nodiscard]] unsigned char decodeSymbol(BitReader& reader);
+
+    void reset();
+
+private:
+    // Nodes are stored by their sibling-property order number, so weights
+    // never decrease with the index and the root is the last node.
+    static constexpr int kMaxNodes = 2 * 256 + 1;
+    static constexpr int kRoot = kMaxNodes - 1;
+
+    struct Node {
+        std::uint64_t weight = 0;
+        int parent = -1;
+        int left = -1;
+        int right = -1;
+        int symbol = -1;
+    };
+
+    std::vector<Node> nodes_;
+    std::array<int, 256> leafOf_{};
+    int nyt_ = kRoot;
+    // Path scratch space for emitting codes root-first
+    std::vector<std::uint8_t> path_;
+
+    void update(unsigned char symbol);
+    void swapNodes(int a, int b);
+    void writePath(int node, BitWriter& writer);
+};
+
+// Streaming encoder: feed data as it arrives and drain completed bytes at
+// any time.
+class AdaptiveHuffmanEncoder {
+public:
+    void encode(std::string_view data);
+
+    // Complete bytes produced since the last call.
+    [[nodiscard]] std::string takeBytes();
+
+    // Flushes the final partial byte. `bytes` holds only what takeBytes()
+    // has not already returned; bit and symbol counts cover the whole stream.
+    [[nodiscard]] PackedBits finish();
+
+private:
+    AdaptiveHuffmanTree tree_;
+    BitWriter writer_;
+    std::size_t symbols_ = 0;
+};
+
+class AdaptiveHuffmanDecoder {
+public:
+    [[nodiscard]] std::string decode(const PackedBits& packed) const;
+    [[nodiscard]] std::string decode(std::string_view bytes, std::size_t bitCount,
+                                     std::size_t symbolCount) const;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_ADAPTIVE_H
@@ -0,0 +1,87 @@
+#ifndef HUFFMAN_BATCH_H
+#define HUFFMAN_BATCH_H
+
+#include "code_table.h"
+#include "table_decoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Messages stored back to back in one buffer: message i is
+// data[offsets[i], offsets[i + 1]).
+struct MessageArena {
+    std::string data;
+    std::vector<std::uint64_t> offsets{0};
+
+    void append(std::string_view message) {
+        data.append(message);
+        offsets.push_back(data.size());
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return offsets.size() - 1; }
+    [[nodiscard]] std::string_view operator[](std::size_t index) const {
+        return std::string_view(data).substr(static_cast<std::size_t>(offsets[index]),
+                                             static_cast<std::size_t>(offsets[index + 1] - offsets[index]));
+    }
+};
+
+// A batch coded with one shared table. Messages are bit-packed back to back
+// without padding: message i occupies bits [bitOffsets[i], bitOffsets[i + 1])
+// of `bytes` and decodes to rawOffsets[i + 1] - rawOffsets[i] bytes.
+struct EncodedBatch {
+    std::string bytes;
+    std::vector<std::uint64_t> bitOffsets{0};
+    std::vector<std::uint64_t> rawOffsets{0};
+
+    [[nodiscard]] std::size_t size() const noexcept { return bitOffsets.size() - 1; }
+};
+
+// Encodes many small messages with a single table, so the per-message cost
+// is only the codes themselves: no tree, table header or allocation.
+class BatchEncoder {
+public:
+    // `table` must be a byte-alphabet table; messages may only use bytes
+    // that have a code (see train).
+    explicit BatchEncoder(CodeTable table);
+
+    // Table fitted to the combined statistics of `messages`. Every byte gets
+    // a code, so later batches with unseen bytes still encode.
+    [[nodiscard]] static CodeTable train(const std::vector<std::string_view>& messages);
+
+    [[nodiscard]] EncodedBatch encode(const std::string_view* messages, std::size_t count) const;
+    [[nodiscard]] EncodedBatch encode(const std::vector<std::string_view>& messages) const {
+        return encode(messages.data(), messages.size());
+    }
+    [[nodiscard]] EncodedBatch encode(const MessageArena& messages) const;
+
+    [[nodiscard]] const CodeTable& table() const noexcept { return table_; }
+
+private:
+    CodeTable table_;
+};
+
+class BatchDecoder {
+public:
+    // `threads` workers decode disjoint runs of messages; 0 means one per
+    // hardware thread.
+    explicit BatchDecoder(const CodeTable& table, unsigned threads = 1);
+
+    // Decodes every message into one arena with the batch's raw offsets.
+    [[nodiscard]] MessageArena decode(const EncodedBatch& batch) const;
+    // Decodes a single message without touching the others.
+    [[nodiscard]] std::string decodeMessage(const EncodedBatch& batch, std::size_t index) const;
+
+private:
+    TableDecoder decoder_;
+    unsigned threads_;
+    DecodeKernel kernel_;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_BATCH_H
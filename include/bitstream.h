@@ -0,0 +1,153 @@
+#ifndef HUFFMAN_BITSTREAM_H
+#define HUFFMAN_BITSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace huffman {
+
+// Bits are packed LSB-first: the first bit of the stream is bit 0 of byte 0.
+// Codes are written in bit-reversed order so that a reader can peek the next
+// N bits with a single mask.
+
+[[nodiscard]] inline std::uint64_t loadLE64(const unsigned char* p) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+#else
+    std::uint64_t v = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+    }
+    return v;
+#endif
+}
+
+[[nodiscard]] constexpr std::uint32_t reverseBits(std::uint32_t bits, unsigned count) noexcept {
+    std::uint32_t out = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        out = (out << 1) | (bits & 1u);
+        bits >>= 1;
+    }
+    return out;
+}
+
+class BitWriter {
+public:
+    BitWriter() = default;
+
+    // Appends the low `count` bits of `bits` (count <= 32).
+    void write(std::uint32_t bits, unsigned count) {
+        acc_ |= static_cast<std::uint64_t>(bits) << accBits_;
+        accBits_ += count;
+        bitCount_ += count;
+        if (accBits_ >= 32) {
+            for (unsigned i = 0; i < 4; ++i) {
+                out_.push_back(static_cast<char>(acc_ & 0xFF));
+                acc_ >>= 8;
+            }
+            accBits_ -= 32;
+        }
+    }
+
+    void reserveBytes(std::size_t bytes) { out_.reserve(bytes); }
+
+    [[nodiscard]] std::size_t bitCount() const noexcept { return bitCount_; }
+
+    // Removes and returns every complete byte written so far; a partial
+    // byte stays buffered.
+    [[nodiscard]] std::string drainBytes() {
+        while (accBits_ >= 8) {
+            out_.push_back(static_cast<char>(acc_ & 0xFF));
+            acc_ >>= 8;
+            accBits_ -= 8;
+        }
+        std::string bytes = std::move(out_);
+        out_.clear();
+        return bytes;
+    }
+
+    // Flushes the partial byte (zero padded) and returns the packed bytes.
+    [[nodiscard]] std::string finish() {
+        while (accBits_ > 0) {
+            out_.push_back(static_cast<char>(acc_ & 0xFF));
+            acc_ >>= 8;
+            accBits_ = accBits_ > 8 ? accBits_ - 8 : 0;
+        }
+        acc_ = 0;
+        return std::move(out_);
+    }
+
+private:
+    std::string out_;
+    std::uint64_t acc_ = 0;
+    unsigned accBits_ = 0;
+    std::size_t bitCount_ = 0;
+};
+
+class BitReader {
+public:
+    BitReader(std::string_view bytes, std::size_t bitCount) noexcept
+        : BitReader(bytes, 0, bitCount) {}
+
+    // Reads bits [bitBegin, bitEnd) of `bytes`.
+    BitReader(std::string_view bytes, std::size_t bitBegin, std::size_t bitEnd) noexcept
+        : data_(reinterpret_cast<const unsigned char*>(bytes.data())),
+          size_(bytes.size()),
+          bitCount_(bitEnd),
+          pos_(bitBegin >> 3),
+          consumed_(bitBegin & ~std::size_t{7}) {
+        refill();
+        consume(static_cast<unsigned>(bitBegin & 7));
+    }
+
+    // Tops up the bit buffer to at least 56 bits while input remains.
+    void refill() noexcept {
+        if (pos_ + 8 <= size_) {
+            buf_ |= loadLE64(data_ + pos_) << bufBits_;
+            pos_ += (63 - bufBits_) >> 3;
+            bufBits_ |= 56;
+            return;
+        }
+        while (bufBits_ <= 56 && pos_ < size_) {
+            buf_ |= static_cast<std::uint64_t>(data_[pos_++]) << bufBits_;
+            bufBits_ += 8;
+        }
+    }
+
+    // Returns the next `count` bits without consuming them; bits past the end
+    // of the input read as zero.
+    [[nodiscard]] std::uint64_t peek(unsigned count) const noexcept {
+        return buf_ & ((std::uint64_t{1} << count) - 1);
+    }
+
+    void consume(unsigned count) noexcept {
+        buf_ >>= count;
+        bufBits_ = bufBits_ > count ? bufBits_ - count : 0;
+        consumed_ += count;
+    }
+
+    [[nodiscard]] std::uint64_t buffer() const noexcept { return buf_; }
+    // Absolute bit position in the input
+    [[nodiscard]] std::size_t position() const noexcept { return consumed_; }
+    [[nodiscard]] std::size_t bitsRemaining() const noexcept {
+        return consumed_ < bitCount_ ? bitCount_ - consumed_ : 0;
+    }
+
+private:
+    const unsigned char* data_;
+    std::size_t size_;
+    std::size_t bitCount_;
+    std::size_t pos_ = 0;
+    std::size_t consumed_ = 0;
+    std::uint64_t buf_ = 0;
+    unsigned bufBits_ = 0;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_BITSTREAM_H
@@ -0,0 +1,28 @@
+#ifndef HUFFMAN_BWT_H
+#define HUFFMAN_BWT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Suffix array of `data` built with SA-IS in linear time.
+[[nodiscard]] std::vector<std::uint32_t> buildSuffixArray(std::string_view data);
+
+// Burrows-Wheeler transform with an implicit end-of-string sentinel. The
+// sentinel is dropped from `data`; `primaryIndex` records where it was.
+struct BwtBlock {
+    std::string data;
+    std::uint32_t primaryIndex = 0;
+};
+
+[[nodiscard]] BwtBlock bwtForward(std::string_view data);
+
+// Throws std::runtime_error if `primaryIndex` cannot come from bwtForward.
+[[nodiscard]] std::string bwtInverse(std::string_view data, std::uint32_t primaryIndex);
+
+} // namespace huffman
+
+#endif // HUFFMAN_BWT_H
@@ -0,0 +1,114 @@
+#ifndef HUFFMAN_BYTE_IO_H
+#define HUFFMAN_BYTE_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace huffman {
+
+// Little-endian serialization helpers for the container formats. `Out` is
+// std::string or SpanWriter.
+
+template <typename Out>
+inline void appendU8(Out& out, std::uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+template <typename Out>
+inline void appendU32(Out& out, std::uint32_t value) {
+    for (unsigned i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+template <typename Out>
+inline void appendU64(Out& out, std::uint64_t value) {
+    for (unsigned i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// Appends into caller memory of fixed size, with the std::string calls the
+// helpers above use. Callers size the buffer from a known bound, so running
+// out of room is a library bug and throws std::length_error.
+class SpanWriter {
+public:
+    SpanWriter(char* data, std::size_t capacity) noexcept : data_(data), capacity_(capacity) {}
+
+    void push_back(char c) {
+        ensureRoom(1);
+        data_[size_++] = c;
+    }
+
+    void append(std::string_view bytes) {
+        ensureRoom(bytes.size());
+        if (!bytes.empty()) {
+            std::memcpy(data_ + size_, bytes.data(), bytes.size());
+        }
+        size_ += bytes.size();
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+    char* data_;
+    std::size_t capacity_;
+    std::size_t size_ = 0;
+
+    void ensureRoom(std::size_t count) const {
+        if (count > capacity_ - size_) {
+            throw std::length_error("Encoded stream exceeds its size bound");
+        }
+    }
+};
+
+// Bounds-checked reader; throws std::runtime_error on truncated input.
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data) noexcept : data_(data) {}
+
+    [[nodiscard]] std::uint8_t u8() {
+        return static_cast<std::uint8_t>(bytes(1)[0]);
+    }
+
+    [[nodiscard]] std::uint32_t u32() {
+        return static_cast<std::uint32_t>(little(4));
+    }
+
+    [[nodiscard]] std::uint64_t u64() {
+        return little(8);
+    }
+
+    [[nodiscard]] std::string_view bytes(std::size_t count) {
+        if (count > data_.size() - pos_) {
+            throw std::runtime_error("Invalid stream: unexpected end of data");
+        }
+        const std::string_view view = data_.substr(pos_, count);
+        pos_ += count;
+        return view;
+    }
+
+    [[nodiscard]] std::size_t position() const noexcept { return pos_; }
+    [[nodiscard]] std::size_t remaining() const noexcept { return data_.size() - pos_; }
+
+private:
+    std::string_view data_;
+    std::size_t pos_ = 0;
+
+    [[nodiscard]] std::uint64_t little(std::size_t count) {
+        const std::string_view raw = bytes(count);
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(raw[i])) << (8 * i);
+        }
+        return value;
+    }
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_BYTE_IO_H
@@ -0,0 +1,93 @@
+#ifndef HUFFMAN_CODE_TABLE_H
+#define HUFFMAN_CODE_TABLE_H
+
+#include "bitstream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+template <typename Symbol, std::size_t MaxSymbols>
+class BasicHuffmanTree;
+using HuffmanTree = BasicHuffmanTree<char, 256>;
+
+// A single prefix code; `bits` holds the code MSB-first, as it would be read
+// from a '0'/'1' string.
+struct Code {
+    std::uint32_t bits = 0;
+    std::uint8_t length = 0;
+};
+
+// Output of bit-packed encoding.
+struct PackedBits {
+    std::string bytes;
+    std::size_t bitCount = 0;
+    std::size_t symbolCount = 0;
+};
+
+// Rewrites `lengths` so that no code is longer than `maxLength` while keeping
+// the code complete or under-full (Kraft sum <= 1).
+void limitCodeLengths(std::vector<std::uint8_t>& lengths, unsigned maxLength);
+
+// Optimal code lengths for `frequencies` (one entry per symbol, zero for
+// unused symbols), limited to `maxLength` bits.
+[[nodiscard]] std::vector<std::uint8_t> buildCodeLengths(
+    const std::vector<std::uint64_t>& frequencies, unsigned maxLength);
+
+// Canonical Huffman code built from per-symbol code lengths. Only the lengths
+// need to be transmitted to reconstruct it, which makes it the basis of the
+// bit-packed format and the table-driven decoders.
+class CodeTable {
+public:
+    static constexpr unsigned kMaxCodeLength = 16;
+
+    CodeTable() = default;
+    explicit CodeTable(std::vector<std::uint8_t> lengths);
+
+    // Byte-alphabet table with the code lengths of `tree`, limited to
+    // kMaxCodeLength if the tree is deeper.
+    [[nodiscard]] static CodeTable fromTree(const HuffmanTree& tree);
+    // Table for an arbitrary alphabet, one frequency per symbol.
+    [[nodiscard]] static CodeTable fromFrequencies(const std::vector<std::uint64_t>& frequencies);
+
+    [[nodiscard]] PackedBits encode(std::string_view text) const;
+    // Appends the codes for `text` to an existing bit stream.
+    void encodeTo(BitWriter& writer, std::string_view text) const;
+
+    // Appends the code of one symbol; throws if the symbol has no code.
+    void writeSymbol(BitWriter& writer, std::size_t symbol) const {
+        if (symbol >= lengths_.size() || lengths_[symbol] == 0) {
+            throw std::runtime_error("Symbol " + std::to_string(symbol) + " not found in code table");
+        }
+        writer.write(reversed_[symbol], lengths_[symbol]);
+    }
+
+    [[nodiscard]] const std::vector<std::uint8_t>& lengths() const noexcept { return lengths_; }
+    [[nodiscard]] const Code& code(std::size_t symbol) const { return codes_.at(symbol); }
+    [[nodiscard]] std::size_t alphabetSize() const noexcept { return lengths_.size(); }
+    [[nodiscard]] unsigned maxLength() const noexcept { return maxLength_; }
+
+    // Number of codes of each length (index 0 unused).
+    [[nodiscard]] const std::vector<std::uint16_t>& lengthCounts() const noexcept { return counts_; }
+    // Symbols ordered by (length, symbol), i.e. canonical code order.
+    [[nodiscard]] const std::vector<std::uint16_t>& sortedSymbols() const noexcept { return sorted_; }
+
+    [[nodiscard]] bool empty() const noexcept { return sorted_.empty(); }
+
+private:
+    std::vector<std::uint8_t> lengths_;
+    std::vector<Code> codes_;
+    std::vector<std::uint32_t> reversed_;
+    std::vector<std::uint16_t> counts_;
+    std::vector<std::uint16_t> sorted_;
+    unsigned maxLength_ = 0;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_CODE_TABLE_H
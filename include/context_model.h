@@ -0,0 +1,60 @@
+#ifndef HUFFMAN_CONTEXT_MODEL_H
+#define HUFFMAN_CONTEXT_MODEL_H
+
+#include "bitstream.h"
+#include "code_table.h"
+#include "table_decoder.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Order-1 context model: each byte is coded with a table selected by the
+// byte before it (0 at the start). The 256 contexts are clustered into a
+// small number of tables so the header stays compact; contexts with similar
+// statistics share one.
+class ContextModel {
+public:
+    static constexpr unsigned kMaxTables = 256;
+
+    ContextModel(std::array<std::uint8_t, 256> tableOf, std::vector<CodeTable> tables);
+
+    // Gathers order-1 statistics for `data` and clusters the contexts into
+    // at most `maxTables` tables.
+    [[nodiscard]] static ContextModel build(std::string_view data, unsigned maxTables = 16);
+
+    void encodeTo(BitWriter& writer, std::string_view data) const;
+
+    // Payload size in bits for the data the model was built from.
+    [[nodiscard]] std::uint64_t encodedBits() const noexcept { return encodedBits_; }
+
+    [[nodiscard]] const std::array<std::uint8_t, 256>& tableOf() const noexcept { return tableOf_; }
+    [[nodiscard]] const std::vector<CodeTable>& tables() const noexcept { return tables_; }
+
+private:
+    std::array<std::uint8_t, 256> tableOf_;
+    std::vector<CodeTable> tables_;
+    std::uint64_t encodedBits_ = 0;
+};
+
+// Table-driven decoder for data coded with a ContextModel.
+class ContextDecoder {
+public:
+    explicit ContextDecoder(const ContextModel& model);
+
+    // Decodes exactly `symbolCount` bytes from bits [0, bitCount) of `bytes`.
+    void decodeInto(char* out, std::size_t symbolCount, std::string_view bytes,
+                    std::size_t bitCount) const;
+
+private:
+    std::array<std::uint8_t, 256> tableOf_;
+    std::vector<TableDecoder> decoders_;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_CONTEXT_MODEL_H
@@ -0,0 +1,64 @@
+#ifndef HUFFMAN_CPU_FEATURES_H
+#define HUFFMAN_CPU_FEATURES_H
+
+// x86-64 kernels are compiled with per-function target attributes and chosen
+// at runtime, so the library itself needs no -m flags.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HUFFMAN_X86_DISPATCH 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HUFFMAN_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define HUFFMAN_ALWAYS_INLINE __forceinline
+#else
+#define HUFFMAN_ALWAYS_INLINE inline
+#endif
+
+#include <cstdint>
+
+namespace huffman {
+
+// Trailing zero count of a non-zero value (tzcnt when compiled for BMI1)
+[[nodiscard]] HUFFMAN_ALWAYS_INLINE unsigned countTrailingZeros(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+    unsigned n = 0;
+    while ((value & 1u) == 0) {
+        value >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Runtime CPUID checks; always false on builds without x86 dispatch.
+[[nodiscard]] inline bool cpuHasSse41() noexcept {
+#ifdef HUFFMAN_X86_DISPATCH
+    return __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+}
+
+[[nodiscard]] inline bool cpuHasAvx2() noexcept {
+#ifdef HUFFMAN_X86_DISPATCH
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// BMI1 (tzcnt) and BMI2 (bzhi, shrx) together
+[[nodiscard]] inline bool cpuHasBmi2() noexcept {
+#ifdef HUFFMAN_X86_DISPATCH
+    return __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+} // namespace huffman
+
+#endif // HUFFMAN_CPU_FEATURES_H
@@ -0,0 +1,55 @@
+#ifndef HUFFMAN_FILE_PIPELINE_H
+#define HUFFMAN_FILE_PIPELINE_H
+
+#include "stream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace huffman {
+
+enum class IoBackend {
+    Auto,
+    // Linux io_uring driven through raw syscalls
+    IoUring,
+    // pread/pwrite on a few I/O threads
+    Threads,
+};
+
+[[nodiscard]] const char* backendName(IoBackend backend) noexcept;
+// True if the kernel lets this process create an io_uring (checked once).
+[[nodiscard]] bool isIoUringAvailable() noexcept;
+
+struct FileCompressOptions {
+    StreamOptions stream;
+    // Encode workers; 0 means one per hardware thread
+    unsigned threads = 0;
+    // Blocks in flight at once across reading, encoding and writing
+    std::size_t queueDepth = 8;
+    IoBackend backend = IoBackend::Auto;
+};
+
+struct FileCompressResult {
+    std::uint64_t bytesIn = 0;
+    std::uint64_t bytesOut = 0;
+    IoBackend backend = IoBackend::Threads;
+    // Encoder counters for this file (see StreamEncoder::stats)
+    Stats stats;
+};
+
+// Compresses `inputPath` into a HUFS stream at `outputPath`. Block reads,
+// block encodes on the worker threads and in-order writes of finished blocks
+// overlap, so throughput approaches the slower of I/O and encoding instead of
+// their sum. Blocks are coded independently (no repeated tables), so the
+// output can differ from StreamEncoder::encode on the whole file but decodes
+// the same. Throws std::invalid_argument for bad options and
+// std::runtime_error for I/O failures, after removing the partly written
+// output; IoBackend::IoUring throws if io_uring is unavailable, Auto falls
+// back to threads.
+FileCompressResult compressFile(const std::string& inputPath, const std::string& outputPath,
+                                const FileCompressOptions& options = {});
+
+} // namespace huffman
+
+#endif // HUFFMAN_FILE_PIPELINE_H
@@ -0,0 +1,60 @@
+#ifndef HUFFMAN_HISTOGRAM_H
+#define HUFFMAN_HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace huffman {
+
+using Histogram = std::array<std::uint64_t, 256>;
+
+enum class HistogramKernel {
+    Scalar,
+    Sse4,
+    Avx2,
+};
+
+// Best kernel supported by the running CPU (checked once via CPUID).
+[[nodiscard]] HistogramKernel detectHistogramKernel() noexcept;
+[[nodiscard]] bool isKernelSupported(HistogramKernel kernel) noexcept;
+[[nodiscard]] const char* kernelName(HistogramKernel kernel) noexcept;
+
+// Byte histogram using the best available kernel.
+[[nodiscard]] Histogram computeHistogram(std::string_view data);
+
+// Byte histogram using a specific kernel; throws std::invalid_argument if the
+// CPU does not support it.
+[[nodiscard]] Histogram computeHistogram(std::string_view data, HistogramKernel kernel);
+
+// Byte histogram split across `threads` workers (0 = hardware concurrency).
+// Each worker counts its slice into a private, cache-line aligned table and
+// the partial tables are summed at the end. Inputs smaller than
+// kParallelHistogramMinSlice per worker use fewer threads.
+inline constexpr std::size_t kParallelHistogramMinSlice = std::size_t{1} << 20;
+[[nodiscard]] Histogram computeHistogramParallel(std::string_view data, unsigned threads = 0);
+
+// Shannon entropy in bits per byte; a lower bound for any order-0 coder.
+[[nodiscard]] double entropyBitsPerByte(const Histogram& histogram) noexcept;
+
+// Size in bytes of an order-0 Huffman block for this histogram: the payload
+// under the library's own length-limited code lengths (the same heuristic
+// limiter the encoder uses) plus the 256-byte length table.
+// Only the code lengths are computed, not a tree or the codes themselves.
+[[nodiscard]] std::uint64_t estimateCompressedSize(const Histogram& histogram);
+
+// Histogram of about `sampleBytes` bytes taken as evenly spaced 4 KiB
+// chunks across `data` (all of it when smaller).
+inline constexpr std::size_t kDefaultSampleBytes = std::size_t{64} << 10;
+[[nodiscard]] Histogram sampleHistogram(std::string_view data,
+                                        std::size_t sampleBytes = kDefaultSampleBytes);
+
+// Estimated order-0 Huffman size of `data` from a sample, scaled to the full
+// length; compare against data.size() to skip incompressible input early.
+[[nodiscard]] std::uint64_t estimateCompressedSize(std::string_view data,
+                                                   std::size_t sampleBytes = kDefaultSampleBytes);
+
+} // namespace huffman
+
+#endif // HUFFMAN_HISTOGRAM_H
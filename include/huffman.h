@@ -1,51 +1,488 @@
 #ifndef HUFFMAN_H
 #define HUFFMAN_H
 
-#include <memory>
+#include "histogram.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 namespace huffman {
 
-struct Node {
-    char character;
-    int frequency;
-    std::unique_ptr<Node> left;
-    std::unique_ptr<Node> right;
+// Tree node; children are indices into the owning tree's node arena.
+template <typename Symbol, typename Index>
+struct BasicNode {
+    static constexpr Index kNone = std::numeric_limits<Index>::max();
 
-    Node(char ch, int freq) noexcept;
-    Node(int freq, std::unique_ptr<Node> l, std::unique_ptr<Node> r) noexcept;
+    Symbol symbol{};
+    std::uint64_t frequency = 0;
+    Index left = kNone;
+    Index right = kNone;
 
-    [[nodiscard]] constexpr bool isLeaf() const noexcept {
-        return left == nullptr && right == nullptr;
+    [[nodiscard]] bool isLeaf() const noexcept {
+        return left == kNone && right == kNone;
     }
 };
 
-class HuffmanTree {
+// Node storage for one tree. Capacity only grows, so rebuilding a tree over
+// an alphabet no larger than before does not allocate and reset() is O(1).
+// Index links keep trees valid when they are moved or copied.
+template <typename NodeType>
+class BasicNodeArena {
+public:
+    using Index = decltype(NodeType::left);
+
+    explicit BasicNodeArena(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : nodes_(resource) {}
+
+    [[nodiscard]] Index create(const NodeType& node) {
+        nodes_.push_back(node);
+        return static_cast<Index>(nodes_.size() - 1);
+    }
+
+    [[nodiscard]] const NodeType& operator[](Index index) const noexcept { return nodes_[index]; }
+    [[nodiscard]] std::size_t size() const noexcept { return nodes_.size(); }
+
+    // Drops every node but keeps the storage, growing it to `capacity`.
+    void reset(std::size_t capacity) {
+        nodes_.clear();
+        nodes_.reserve(capacity);
+    }
+
+private:
+    std::pmr::vector<NodeType> nodes_;
+};
+
+// One symbol's tree code: the low `length` bits of `bits`, first bit most
+// significant. A length of 0 means the symbol is not in the tree. Unlike
+// CodeTable's Code, the length is not limited.
+struct TreeCode {
+    std::uint64_t bits = 0;
+    std::uint8_t length = 0;
+
+    // '0'/'1' form, for display and debugging only.
+    [[nodiscard]] std::string toString() const;
+};
+
+// Alphabets up to this size get dense per-symbol tables.
+inline constexpr std::size_t kDenseSymbolLimit = std::size_t{1} << 16;
+
+// Static Huffman tree over symbols in [0, MaxSymbols). Small alphabets keep
+// codes in an array indexed by symbol; larger ones fall back to a hash map.
+// Byte trees take and return strings, other symbol types vectors.
+template <typename Symbol, std::size_t MaxSymbols>
+class BasicHuffmanTree {
+    static_assert(std::is_same_v<Symbol, char> || std::is_unsigned_v<Symbol>,
+                  "symbols are char or an unsigned integer type");
+    static_assert(MaxSymbols >= 1 &&
+                  MaxSymbols - 1 <= std::numeric_limits<std::make_unsigned_t<Symbol>>::max());
+
 public:
-    HuffmanTree() = default;
+    static constexpr bool kDense = MaxSymbols <= kDenseSymbolLimit;
 
-    void buildTree(std::string_view text);
+    using Index = std::conditional_t<(MaxSymbols <= 0x7FFF), std::uint16_t, std::uint32_t>;
+    using Node = BasicNode<Symbol, Index>;
+    using NodeArena = BasicNodeArena<Node>;
+    using Text = std::conditional_t<std::is_same_v<Symbol, char>, std::string_view,
+                                    const std::vector<Symbol>&>;
+    using Sequence = std::conditional_t<std::is_same_v<Symbol, char>, std::string,
+                                        std::vector<Symbol>>;
+    using Codes = std::conditional_t<
+        (MaxSymbols <= 256), std::array<TreeCode, MaxSymbols>,
+        std::conditional_t<kDense, std::vector<TreeCode>, std::unordered_map<Symbol, TreeCode>>>;
 
-    [[nodiscard]] std::string encode(std::string_view text) const;
-    [[nodiscard]] std::string decode(std::string_view encodedText) const;
+    BasicHuffmanTree() = default;
+    // Draws node storage from `resource`, e.g. a pool shared by many trees.
+    explicit BasicHuffmanTree(std::pmr::memory_resource* resource) : nodes_(resource) {}
 
-    [[nodiscard]] const std::unordered_map<char, int>& getFrequencies() const noexcept;
-    [[nodiscard]] const std::unordered_map<char, std::string>& getCodes() const noexcept;
+    // Throws std::invalid_argument if `text` is empty or holds a symbol
+    // outside the alphabet.
+    void buildTree(Text text);
+    // Byte trees only: builds from byte counts computed by the caller.
+    // Throws std::invalid_argument if every count is zero.
+    template <typename S = Symbol, std::enable_if_t<std::is_same_v<S, char>, int> = 0>
+    void buildTree(const Histogram& histogram);
 
-    [[nodiscard]] bool isBuilt() const noexcept { return root_ != nullptr; }
+    [[nodiscard]] std::string encode(Text text) const;
+    [[nodiscard]] Sequence decode(std::string_view encodedText) const;
+
+    [[nodiscard]] const std::unordered_map<Symbol, std::uint64_t>& getFrequencies() const noexcept {
+        return frequencies_;
+    }
+    // Dense tables are indexed by symbol value (bytes as unsigned char).
+    [[nodiscard]] const Codes& getCodes() const noexcept { return huffmanCodes_; }
+    // Code of `symbol`, or nullptr if it is not in the tree.
+    [[nodiscard]] const TreeCode* findCode(Symbol symbol) const noexcept;
+
+    [[nodiscard]] bool isBuilt() const noexcept { return root_ != Node::kNone; }
 
 private:
-    std::unique_ptr<Node> root_;
-    std::unordered_map<char, int> frequencies_;
-    std::unordered_map<char, std::string> huffmanCodes_;
+    NodeArena nodes_;
+    Index root_ = Node::kNone;
+    std::unordered_map<Symbol, std::uint64_t> frequencies_;
+    Codes huffmanCodes_{};
+    std::conditional_t<(MaxSymbols <= 256), std::array<Index, MaxSymbols>, std::vector<Index>>
+        heap_{};
 
-    void calculateFrequencies(std::string_view text);
-    void generateCodes(const Node* node, std::string& code);
+    void calculateFrequencies(Text text);
+    void assignFrequencies(const Histogram& histogram);
+    void clearCodes();
+    // Drops codes, counts and the root, so the tree reads as unbuilt
+    void clear();
+    void buildFromFrequencies();
+    void generateCodes(Index root);
 };
 
+namespace detail {
+
+// Dense table slot of a symbol; bytes index as unsigned char.
+template <typename Symbol>
+std::size_t slotOf(Symbol symbol) noexcept {
+    if constexpr (std::is_same_v<Symbol, char>) {
+        return static_cast<unsigned char>(symbol);
+    } else {
+        return static_cast<std::size_t>(symbol);
+    }
+}
+
+template <typename Symbol>
+std::string describeSymbol(Symbol symbol) {
+    if constexpr (std::is_same_v<Symbol, char>) {
+        return std::string("Character '") + symbol + "'";
+    } else {
+        return "Symbol " + std::to_string(symbol);
+    }
+}
+
+// A leaf at depth d needs a total weight of at least Fibonacci(d + 2), over
+// 2.7e13 symbols for depth 64, so only contrived counts passed to
+// buildTree(const Histogram&) can go deeper (and throw).
+inline constexpr unsigned kMaxTreeDepth = 64;
+
+} // namespace detail
+
+template <typename Symbol, std::size_t MaxSymbols>
+void BasicHuffmanTree<Symbol, MaxSymbols>::calculateFrequencies(Text text) {
+    if constexpr (std::is_same_v<Symbol, char>) {
+        assignFrequencies(computeHistogramParallel(text));
+    } else {
+        frequencies_.clear();
+        if constexpr (kDense) {
+            std::vector<std::uint64_t> counts(MaxSymbols, 0);
+            for (Symbol symbol : text) {
+                ++counts[detail::slotOf(symbol)];
+            }
+            for (std::size_t s = 0; s < counts.size(); ++s) {
+                if (counts[s] != 0) {
+                    frequencies_[static_cast<Symbol>(s)] = counts[s];
+                }
+            }
+        } else {
+            for (Symbol symbol : text) {
+                ++frequencies_[symbol];
+            }
+        }
+    }
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+void BasicHuffmanTree<Symbol, MaxSymbols>::assignFrequencies(const Histogram& histogram) {
+    // Subtree weights are sums of counts, so the total must fit as well
+    std::uint64_t total = 0;
+    for (std::uint64_t count : histogram) {
+        if (count > std::numeric_limits<std::uint64_t>::max() - total) {
+            throw std::invalid_argument("Symbol counts overflow 64 bits");
+        }
+        total += count;
+    }
+
+    frequencies_.clear();
+    for (std::size_t b = 0; b < histogram.size(); ++b) {
+        if (histogram[b] != 0) {
+            frequencies_[static_cast<Symbol>(b)] = histogram[b];
+        }
+    }
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+void BasicHuffmanTree<Symbol, MaxSymbols>::clearCodes() {
+    if constexpr (kDense) {
+        if constexpr (MaxSymbols > 256) {
+            if (huffmanCodes_.empty()) {
+                huffmanCodes_.resize(MaxSymbols);
+                return;
+            }
+        }
+        // Only the previous tree's symbols can hold codes
+        for (const auto& entry : frequencies_) {
+            huffmanCodes_[detail::slotOf(entry.first)] = TreeCode{};
+        }
+    } else {
+        huffmanCodes_.clear();
+    }
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+void BasicHuffmanTree<Symbol, MaxSymbols>::clear() {
+    clearCodes();
+    frequencies_.clear();
+    root_ = Node::kNone;
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+void BasicHuffmanTree<Symbol, MaxSymbols>::buildTree(Text text) {
+    if (text.empty()) {
+        throw std::invalid_argument("Input text cannot be empty");
+    }
+    if constexpr (MaxSymbols - 1 < std::numeric_limits<std::make_unsigned_t<Symbol>>::max()) {
+        for (Symbol symbol : text) {
+            if (detail::slotOf(symbol) >= MaxSymbols) {
+                throw std::invalid_argument(detail::describeSymbol(symbol) +
+                                            " is outside the alphabet");
+            }
+        }
+    }
+
+    clear();
+    calculateFrequencies(text);
+    buildFromFrequencies();
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+template <typename S, std::enable_if_t<std::is_same_v<S, char>, int>>
+void BasicHuffmanTree<Symbol, MaxSymbols>::buildTree(const Histogram& histogram) {
+    if (std::all_of(histogram.begin(), histogram.end(), [](std::uint64_t n) { return n == 0; })) {
+        throw std::invalid_argument("Input text cannot be empty");
+    }
+
+    clear();
+    assignFrequencies(histogram);
+    buildFromFrequencies();
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+void BasicHuffmanTree<Symbol, MaxSymbols>::buildFromFrequencies() {
+    // Small alphabets reserve the worst case once; others grow as needed
+    const std::size_t symbols = MaxSymbols <= 256 ? MaxSymbols : frequencies_.size();
+    nodes_.reset(std::max<std::size_t>(2 * symbols - 1, 2));
+
+    // Comparator for min-heap based on frequency
+    auto cmp = [this](Index a, Index b) {
+        return nodes_[a].frequency > nodes_[b].frequency;
+    };
+
+    // Min-heap of subtree roots in reused storage: no allocation per build
+    if constexpr (MaxSymbols > 256) {
+        heap_.resize(frequencies_.size());
+    }
+    std::size_t heapSize = 0;
+    auto push = [&](Index node) {
+        heap_[heapSize++] = node;
+        std::push_heap(heap_.begin(), heap_.begin() + static_cast<std::ptrdiff_t>(heapSize), cmp);
+    };
+    auto pop = [&] {
+        std::pop_heap(heap_.begin(), heap_.begin() + static_cast<std::ptrdiff_t>(heapSize), cmp);
+        return heap_[--heapSize];
+    };
+
+    // Create leaf nodes for each symbol
+    for (const auto& [symbol, freq] : frequencies_) {
+        push(nodes_.create(Node{symbol, freq, Node::kNone, Node::kNone}));
+    }
+
+    // Handle single unique symbol case
+    if (heapSize == 1) {
+        const Index leaf = heap_[0];
+        root_ = nodes_.create(Node{Symbol{}, nodes_[leaf].frequency, leaf, Node::kNone});
+    } else {
+        // Build the Huffman tree
+        while (heapSize > 1) {
+            const Index left = pop();
+            const Index right = pop();
+
+            const std::uint64_t sumFreq = nodes_[left].frequency + nodes_[right].frequency;
+            push(nodes_.create(Node{Symbol{}, sumFreq, left, right}));
+        }
+
+        root_ = heap_[0];
+    }
+
+    // Generate Huffman codes; a tree too deep for them is not left half built
+    try {
+        generateCodes(root_);
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+void BasicHuffmanTree<Symbol, MaxSymbols>::generateCodes(Index root) {
+    if (root == Node::kNone) return;
+
+    // Explicit depth-first walk on a fixed array: at most one pending sibling
+    // per level plus the node being expanded, so kMaxTreeDepth + 2 frames
+    // always suffice. Each frame carries its code as a 64-bit word, which is
+    // why a tree deeper than 64 levels throws rather than being walked.
+    struct Frame {
+        Index index;
+        std::uint8_t length;
+        std::uint64_t bits;
+    };
+    std::array<Frame, detail::kMaxTreeDepth + 2> stack;
+    std::size_t top = 0;
+    stack[top++] = Frame{root, 0, 0};
+
+    while (top != 0) {
+        const Frame frame = stack[--top];
+        const Node& node = nodes_[frame.index];
+        if (node.isLeaf()) {
+            // Single symbol case: assign "0" if code is empty
+            const std::uint8_t length = frame.length == 0 ? 1 : frame.length;
+            const TreeCode code{frame.bits, length};
+            if constexpr (kDense) {
+                huffmanCodes_[detail::slotOf(node.symbol)] = code;
+            } else {
+                huffmanCodes_[node.symbol] = code;
+            }
+            continue;
+        }
+
+        if (frame.length == detail::kMaxTreeDepth) {
+            throw std::runtime_error("Huffman tree deeper than 64 levels");
+        }
+        const auto childLength = static_cast<std::uint8_t>(frame.length + 1);
+        if (node.right != Node::kNone) {
+            stack[top++] = Frame{node.right, childLength, (frame.bits << 1) | 1u};
+        }
+        if (node.left != Node::kNone) {
+            stack[top++] = Frame{node.left, childLength, frame.bits << 1};
+        }
+    }
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+const TreeCode* BasicHuffmanTree<Symbol, MaxSymbols>::findCode(Symbol symbol) const noexcept {
+    if constexpr (kDense) {
+        const std::size_t slot = detail::slotOf(symbol);
+        if (slot >= huffmanCodes_.size() || huffmanCodes_[slot].length == 0) {
+            return nullptr;
+        }
+        return &huffmanCodes_[slot];
+    } else {
+        const auto it = huffmanCodes_.find(symbol);
+        return it == huffmanCodes_.end() ? nullptr : &it->second;
+    }
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+std::string BasicHuffmanTree<Symbol, MaxSymbols>::encode(Text text) const {
+    if (!isBuilt()) {
+        throw std::runtime_error("Tree not built. Call buildTree first.");
+    }
+
+    // Pre-calculate total encoded size for efficient allocation
+    size_t totalSize = 0;
+    for (Symbol symbol : text) {
+        const TreeCode* code = findCode(symbol);
+        if (code == nullptr) {
+            throw std::runtime_error(detail::describeSymbol(symbol) + " not found in Huffman tree");
+        }
+        totalSize += code->length;
+    }
+
+    std::string encoded(totalSize, '0');
+    std::size_t pos = 0;
+    for (Symbol symbol : text) {
+        const TreeCode& code = *findCode(symbol);
+        for (unsigned shift = code.length; shift-- > 0; ++pos) {
+            if ((code.bits >> shift) & 1u) {
+                encoded[pos] = '1';
+            }
+        }
+    }
+
+    return encoded;
+}
+
+template <typename Symbol, std::size_t MaxSymbols>
+auto BasicHuffmanTree<Symbol, MaxSymbols>::decode(std::string_view encodedText) const
+    -> Sequence {
+    if (!isBuilt()) {
+        throw std::runtime_error("Tree not built. Call buildTree first.");
+    }
+
+    // Handle single symbol tree specially
+    const Node& root = nodes_[root_];
+    if (root.right == Node::kNone) {
+        Sequence decoded;
+        decoded.reserve(encodedText.size());
+        for (char bit : encodedText) {
+            if (bit != '0') {
+                throw std::invalid_argument(
+                    "Invalid encoded text for single-character tree");
+            }
+            decoded.push_back(nodes_[root.left].symbol);
+        }
+        return decoded;
+    }
+
+    Sequence decoded;
+    decoded.reserve(encodedText.size() / 4);  // Estimate: avg 4 bits per symbol
+
+    Index current = root_;
+
+    for (char bit : encodedText) {
+        if (bit == '0') {
+            current = nodes_[current].left;
+        } else if (bit == '1') {
+            current = nodes_[current].right;
+        } else {
+            throw std::invalid_argument(
+                "Invalid encoded text. Must contain only '0' and '1' characters.");
+        }
+
+        if (current == Node::kNone) {
+            throw std::runtime_error("Invalid encoded text: traversal went beyond tree");
+        }
+
+        if (nodes_[current].isLeaf()) {
+            decoded.push_back(nodes_[current].symbol);
+            current = root_;
+        }
+    }
+
+    // Verify we ended at the root (complete decoding)
+    if (current != root_) {
+        throw std::runtime_error(
+            "Invalid encoded text: incomplete sequence (does not end at a character)");
+    }
+
+    return decoded;
+}
+
+using HuffmanTree = BasicHuffmanTree<char, 256>;
+using HuffmanTree16 = BasicHuffmanTree<std::uint16_t, std::size_t{1} << 16>;
+using HuffmanTree32 = BasicHuffmanTree<std::uint32_t, std::size_t{1} << 32>;
+
+using Node = HuffmanTree::Node;
+using NodeArena = HuffmanTree::NodeArena;
+using CodeArray = HuffmanTree::Codes;
+
+// Instantiated once in huffman.cpp.
+extern template class BasicHuffmanTree<char, 256>;
+extern template class BasicHuffmanTree<std::uint16_t, std::size_t{1} << 16>;
+extern template class BasicHuffmanTree<std::uint32_t, std::size_t{1} << 32>;
+
 } // namespace huffman
 
 #endif // HUFFMAN_H
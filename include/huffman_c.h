@@ -0,0 +1,127 @@
+#ifndef HUFFMAN_C_H
+#define HUFFMAN_C_H
+
+/* C interface to the HUFS stream format, exported by libhuffman.so.
+ *
+ * All functions work on caller-provided buffers and never hand out memory
+ * that the caller must free, other than the context itself. They still
+ * allocate internally: per-block code tables and encoding temporaries, and
+ * for huff_compress with less than huff_compress_bound room, a staging copy
+ * of the stream kept in the context. A context is not thread-safe; use one
+ * per thread. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define HUFF_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define HUFF_API __attribute__((visibility("default")))
+#else
+#define HUFF_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum huff_status {
+    HUFF_OK = 0,
+    HUFF_ERROR_INVALID_ARGUMENT = -1,
+    /* The output does not fit; the required size is reported in *dst_size. */
+    HUFF_ERROR_DST_TOO_SMALL = -2,
+    HUFF_ERROR_CORRUPT_INPUT = -3,
+    HUFF_ERROR_OUT_OF_MEMORY = -4,
+    HUFF_ERROR_INTERNAL = -5
+} huff_status;
+
+typedef struct huff_options {
+    /* sizeof(huff_options), set by huff_options_init. Later versions only
+     * append fields: a smaller struct from an older header gets defaults for
+     * the fields it lacks, and fields from a newer header are ignored. */
+    size_t struct_size;
+    /* Raw bytes per block. */
+    size_t block_size;
+    /* Symbols between sync points; 0 disables them. */
+    size_t sync_interval;
+    /* Decode threads; 0 means one per hardware thread. */
+    unsigned threads;
+    /* Order-1 context tables per block; 0 disables context modeling. */
+    unsigned context_tables;
+    /* LZ77 level 1..9; 0 disables match finding. */
+    unsigned lz77_level;
+    /* Nonzero to append a block index for random access. */
+    int block_index;
+    /* Nonzero to try run-length and BWT coding per block. */
+    int run_length;
+    int bwt;
+} huff_options;
+
+typedef struct huff_context huff_context;
+
+/* Library counters (see huff_get_stats). Stage times are nanoseconds. */
+typedef struct huff_stats {
+    /* sizeof(huff_stats), set by the caller before huff_get_stats. Only the
+     * counters that fit in struct_size are written, so later versions can
+     * append counters. */
+    size_t struct_size;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t blocks;
+    uint64_t tables_built;
+    uint64_t tables_reused;
+    uint64_t stored_blocks;
+    uint64_t histogram_ns;
+    uint64_t build_ns;
+    uint64_t encode_ns;
+    uint64_t decode_ns;
+} huff_stats;
+
+typedef enum huff_stats_kind {
+    HUFF_STATS_COMPRESS = 0,
+    HUFF_STATS_DECOMPRESS = 1
+} huff_stats_kind;
+
+/* Fills `options` with the library defaults (single-threaded decode). */
+HUFF_API void huff_options_init(huff_options* options);
+
+/* Returns NULL if the options are invalid or memory is exhausted. A NULL
+ * `options` selects the defaults. */
+HUFF_API huff_context* huff_context_create(const huff_options* options);
+HUFF_API void huff_context_free(huff_context* context);
+
+/* Largest stream huff_compress can produce for `src_size` input bytes. */
+HUFF_API size_t huff_compress_bound(const huff_context* context, size_t src_size);
+
+/* Compresses `src` into `dst` and stores the stream size in *dst_size. With
+ * at least huff_compress_bound bytes of room the stream is written to `dst`
+ * directly; a smaller `dst` costs a staging copy. */
+HUFF_API huff_status huff_compress(huff_context* context, const void* src, size_t src_size,
+                                   void* dst, size_t dst_capacity, size_t* dst_size);
+
+/* Reads the uncompressed size from a stream header. */
+HUFF_API huff_status huff_decompressed_size(const void* src, size_t src_size, uint64_t* size);
+
+/* Decompresses `src` straight into `dst` and stores the size in *dst_size. */
+HUFF_API huff_status huff_decompress(huff_context* context, const void* src, size_t src_size,
+                                     void* dst, size_t dst_capacity, size_t* dst_size);
+
+/* Nonzero if the library was built with statistics; otherwise every
+ * counter stays zero. */
+HUFF_API int huff_stats_enabled(void);
+/* Copies the compress or decompress counters of `context` into `stats`,
+ * whose struct_size must be set; counters past struct_size are left alone. */
+HUFF_API huff_status huff_get_stats(const huff_context* context, huff_stats_kind kind,
+                                    huff_stats* stats);
+HUFF_API void huff_reset_stats(huff_context* context);
+
+/* Message for the last failed call on `context`; empty if none. */
+HUFF_API const char* huff_last_error(const huff_context* context);
+HUFF_API const char* huff_status_string(huff_status status);
+HUFF_API const char* huff_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HUFFMAN_C_H */
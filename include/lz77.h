@@ -0,0 +1,83 @@
+#ifndef HUFFMAN_LZ77_H
+#define HUFFMAN_LZ77_H
+
+#include "bitstream.h"
+#include "code_table.h"
+#include "table_decoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+struct Lz77Options {
+    // Matches reach back at most 2^windowBits bytes (8 to 24)
+    unsigned windowBits = 15;
+    // 1 (fast, short hash chains) to 9 (slow, long chains with lazy matching)
+    unsigned level = 6;
+};
+
+// One parsed element: a literal byte when distance is 0, otherwise a copy of
+// `length` bytes starting `distance` bytes back.
+struct Lz77Token {
+    std::uint32_t length = 0;
+    std::uint32_t distance = 0;
+};
+
+inline constexpr unsigned kLz77MinMatch = 3;
+inline constexpr unsigned kLz77MaxMatch = 258;
+
+// Greedy/lazy hash-chain parse of `data` into literals and back-references.
+[[nodiscard]] std::vector<Lz77Token> parseLz77(std::string_view data, const Lz77Options& options = {});
+
+// Entropy coder for LZ77 tokens with three Huffman tables: literals plus a
+// match marker, match lengths, and distances. Lengths and distances are
+// coded as a log2 bucket followed by raw extra bits.
+class Lz77Model {
+public:
+    static constexpr std::size_t kMatchSymbol = 256;
+    static constexpr std::size_t kLiteralSymbols = 257;
+    static constexpr std::size_t kLengthSymbols = 16;
+    static constexpr std::size_t kDistanceSymbols = 48;
+
+    Lz77Model(CodeTable literals, CodeTable lengths, CodeTable distances);
+
+    [[nodiscard]] static Lz77Model build(const std::vector<Lz77Token>& tokens);
+
+    void encodeTo(BitWriter& writer, const std::vector<Lz77Token>& tokens) const;
+
+    // Payload size in bits for the tokens the model was built from.
+    [[nodiscard]] std::uint64_t encodedBits() const noexcept { return encodedBits_; }
+
+    [[nodiscard]] const CodeTable& literals() const noexcept { return literals_; }
+    [[nodiscard]] const CodeTable& lengths() const noexcept { return lengths_; }
+    [[nodiscard]] const CodeTable& distances() const noexcept { return distances_; }
+
+private:
+    CodeTable literals_;
+    CodeTable lengths_;
+    CodeTable distances_;
+    std::uint64_t encodedBits_ = 0;
+};
+
+// Table-driven decoder for data coded with an Lz77Model.
+class Lz77Decoder {
+public:
+    explicit Lz77Decoder(const Lz77Model& model);
+
+    // Decodes exactly `size` bytes from bits [0, bitCount) of `bytes`.
+    void decodeInto(char* out, std::size_t size, std::string_view bytes,
+                    std::size_t bitCount) const;
+
+private:
+    std::optional<TableDecoder> literals_;
+    std::optional<TableDecoder> lengths_;
+    std::optional<TableDecoder> distances_;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_LZ77_H
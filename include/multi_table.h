@@ -0,0 +1,63 @@
+#ifndef HUFFMAN_MULTI_TABLE_H
+#define HUFFMAN_MULTI_TABLE_H
+
+#include "bitstream.h"
+#include "code_table.h"
+#include "table_decoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Token coder that switches between several Huffman tables, choosing one per
+// group of kGroupSize tokens (the bzip2 scheme). Per-group selectors are
+// move-to-front and unary coded ahead of the tokens.
+class MultiTableModel {
+public:
+    static constexpr std::size_t kGroupSize = 50;
+    static constexpr unsigned kMaxTables = 6;
+
+    explicit MultiTableModel(std::vector<CodeTable> tables);
+
+    // Picks the table count from the token count (capped at `maxTables`) and
+    // refines table contents and group selection over a few passes.
+    [[nodiscard]] static MultiTableModel build(const std::vector<std::uint16_t>& tokens,
+                                               std::size_t alphabetSize,
+                                               unsigned maxTables = kMaxTables);
+
+    // Writes selectors then tokens; `tokens` must be the ones the model was
+    // built from.
+    void encodeTo(BitWriter& writer, const std::vector<std::uint16_t>& tokens) const;
+
+    // Payload size in bits, selectors included, for the tokens the model was
+    // built from.
+    [[nodiscard]] std::uint64_t encodedBits() const noexcept { return encodedBits_; }
+
+    [[nodiscard]] const std::vector<CodeTable>& tables() const noexcept { return tables_; }
+    [[nodiscard]] const std::vector<std::uint8_t>& selectors() const noexcept { return selectors_; }
+
+private:
+    std::vector<CodeTable> tables_;
+    std::vector<std::uint8_t> selectors_;
+    std::uint64_t encodedBits_ = 0;
+};
+
+class MultiTableDecoder {
+public:
+    explicit MultiTableDecoder(const MultiTableModel& model);
+
+    // Decodes exactly `tokenCount` tokens from bits [0, bitCount) of `bytes`.
+    [[nodiscard]] std::vector<std::uint16_t> decode(std::string_view bytes, std::size_t bitCount,
+                                                    std::size_t tokenCount) const;
+
+private:
+    std::vector<std::optional<TableDecoder>> decoders_;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_MULTI_TABLE_H
@@ -0,0 +1,67 @@
+#ifndef HUFFMAN_PARALLEL_H
+#define HUFFMAN_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace huffman {
+
+// Resolves a requested worker count; 0 means one per hardware thread.
+[[nodiscard]] inline unsigned resolveThreadCount(unsigned threads) noexcept {
+    return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Calls fn(i) for every i in [0, count) on up to `threads` workers, the
+// calling thread included. Tasks are handed out dynamically. The first
+// exception thrown by a task is rethrown after all workers have finished.
+template <typename Fn>
+void parallelFor(std::size_t count, unsigned threads, Fn&& fn) {
+    const std::size_t workers = std::min<std::size_t>(resolveThreadCount(threads), count);
+    if (workers <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto work = [&]() {
+        for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(count);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (std::size_t w = 1; w < workers; ++w) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace huffman
+
+#endif // HUFFMAN_PARALLEL_H
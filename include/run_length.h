@@ -0,0 +1,74 @@
+#ifndef HUFFMAN_RUN_LENGTH_H
+#define HUFFMAN_RUN_LENGTH_H
+
+#include "bitstream.h"
+#include "code_table.h"
+#include "table_decoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Run tokens extend the byte alphabet. A run of n repeats is written as the
+// bijective base-2 digits of n, least significant first: RUNA adds 1 x the
+// digit weight, RUNB adds 2 x (as in bzip2), so a run costs O(log n) tokens.
+inline constexpr std::uint16_t kRunA = 256;
+inline constexpr std::uint16_t kRunB = 257;
+
+// Appends the digit tokens for a run of `count` (> 0) repeats.
+void appendRunTokens(std::vector<std::uint16_t>& tokens, std::size_t count);
+
+// Replaces repeats of the previous byte (0 before the first) with run
+// tokens; every other byte is kept as a literal token.
+[[nodiscard]] std::vector<std::uint16_t> runLengthTokens(std::string_view data);
+
+// Replaces runs of zero bytes with run tokens and keeps other bytes as
+// literals; suited to move-to-front output, where zeros dominate.
+[[nodiscard]] std::vector<std::uint16_t> zeroRunTokens(std::string_view data);
+
+// Inverse of zeroRunTokens; throws std::runtime_error unless the tokens
+// expand to exactly `size` bytes.
+[[nodiscard]] std::string expandZeroRuns(const std::vector<std::uint16_t>& tokens, std::size_t size);
+
+// Single Huffman table over literals and run tokens.
+class RunLengthModel {
+public:
+    static constexpr std::size_t kAlphabetSize = 258;
+
+    explicit RunLengthModel(CodeTable table);
+
+    [[nodiscard]] static RunLengthModel build(const std::vector<std::uint16_t>& tokens);
+
+    void encodeTo(BitWriter& writer, const std::vector<std::uint16_t>& tokens) const;
+
+    // Payload size in bits for the tokens the model was built from.
+    [[nodiscard]] std::uint64_t encodedBits() const noexcept { return encodedBits_; }
+    [[nodiscard]] const CodeTable& table() const noexcept { return table_; }
+
+private:
+    CodeTable table_;
+    std::uint64_t encodedBits_ = 0;
+};
+
+// Decodes tokens and expands runs with a fill, so long runs cost almost
+// nothing to decode.
+class RunLengthDecoder {
+public:
+    explicit RunLengthDecoder(const RunLengthModel& model);
+
+    // Decodes exactly `size` bytes from bits [0, bitCount) of `bytes`.
+    void decodeInto(char* out, std::size_t size, std::string_view bytes,
+                    std::size_t bitCount) const;
+
+private:
+    std::optional<TableDecoder> decoder_;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_RUN_LENGTH_H
@@ -0,0 +1,33 @@
+#ifndef HUFFMAN_SPECULATIVE_DECODER_H
+#define HUFFMAN_SPECULATIVE_DECODER_H
+
+#include "table_decoder.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace huffman {
+
+// Chunks smaller than this are not worth a thread of their own
+inline constexpr std::size_t kSpeculativeMinChunkBits = std::size_t{1} << 16;
+
+// Decodes a bit-packed payload that has no sync-point index on up to
+// `threads` workers (0 = hardware concurrency).
+//
+// The payload is cut into chunks at arbitrary bit offsets. Every worker but
+// the first starts decoding mid-codeword, relying on Huffman codes being
+// self-synchronizing: a decode that starts at the wrong bit soon falls onto
+// the true codeword boundaries and stays there. The chunks are then stitched
+// in order by re-decoding each chunk head from the true end of its
+// predecessor until it meets a boundary the speculative pass also saw;
+// everything from there on is kept. A chunk that never resynchronizes within
+// its recorded window is decoded again from its true start.
+[[nodiscard]] std::string decodeSpeculative(const TableDecoder& decoder, std::string_view bytes,
+                                            std::size_t bitCount, std::size_t symbolCount,
+                                            unsigned threads = 0,
+                                            DecodeKernel kernel = detectDecodeKernel());
+
+} // namespace huffman
+
+#endif // HUFFMAN_SPECULATIVE_DECODER_H
@@ -0,0 +1,213 @@
+#ifndef HUFFMAN_STATIC_CODE_H
+#define HUFFMAN_STATIC_CODE_H
+
+#include "bitstream.h"
+#include "code_table.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Canonical code over a fixed alphabet whose encode and decode tables can be
+// built at compile time from a code-length array, e.g.
+//
+//   constexpr StaticCodeTable<256, 10> kCode{lengths};
+//
+// Every code fits the TableBits-wide lookup index, so decoding is one table
+// load per symbol with the width known to the compiler. The code is the same
+// canonical code CodeTable builds from these lengths, so streams are
+// interchangeable with the runtime tables.
+template <std::size_t N, unsigned TableBits>
+class StaticCodeTable {
+    static_assert(N >= 1 && N <= 0x10000, "alphabet must have 1..65536 symbols");
+    static_assert(TableBits >= 1 && TableBits <= CodeTable::kMaxCodeLength,
+                  "table width must be 1..16 bits");
+
+public:
+    static constexpr std::size_t kAlphabetSize = N;
+    static constexpr unsigned kTableBits = TableBits;
+
+    // Throws std::invalid_argument (a compile error in constant evaluation)
+    // if a length exceeds TableBits, the lengths over-subscribe the code
+    // space, or no symbol has a code.
+    explicit constexpr StaticCodeTable(const std::array<std::uint8_t, N>& lengths)
+        : lengths_(lengths) {
+        std::array<std::uint32_t, TableBits + 1> counts{};
+        for (const std::uint8_t len : lengths_) {
+            if (len > TableBits) {
+                throw std::invalid_argument("Code length exceeds the table width");
+            }
+            if (len > 0) {
+                ++counts[len];
+            }
+        }
+
+        std::int64_t left = 1;
+        bool any = false;
+        for (unsigned len = 1; len <= TableBits; ++len) {
+            left = 2 * left - counts[len];
+            any = any || counts[len] != 0;
+            if (left < 0) {
+                throw std::invalid_argument("Code lengths over-subscribe the code space");
+            }
+        }
+        if (!any) {
+            throw std::invalid_argument("Code table is empty");
+        }
+
+        // First canonical code of each length
+        std::array<std::uint32_t, TableBits + 1> nextCode{};
+        std::uint32_t code = 0;
+        for (unsigned len = 1; len <= TableBits; ++len) {
+            code = (code + counts[len - 1]) << 1;
+            nextCode[len] = code;
+        }
+
+        for (std::size_t sym = 0; sym < N; ++sym) {
+            const unsigned len = lengths_[sym];
+            if (len == 0) continue;
+            codes_[sym] = nextCode[len]++;
+            reversed_[sym] = reverseBits(codes_[sym], len);
+            // Every index whose low `len` bits are this code decodes to it
+            for (std::size_t index = reversed_[sym]; index < table_.size();
+                 index += std::size_t{1} << len) {
+                table_[index] = Entry{static_cast<std::uint16_t>(sym), static_cast<std::uint8_t>(len)};
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr const std::array<std::uint8_t, N>& lengths() const noexcept {
+        return lengths_;
+    }
+    [[nodiscard]] constexpr Code code(std::size_t symbol) const {
+        return Code{codes_.at(symbol), lengths_.at(symbol)};
+    }
+    // Runtime table with the same code, for the stream and TableDecoder paths.
+    [[nodiscard]] CodeTable toCodeTable() const {
+        return CodeTable(std::vector<std::uint8_t>(lengths_.begin(), lengths_.end()));
+    }
+
+    // Appends the code of one symbol; throws if the symbol has no code.
+    void writeSymbol(BitWriter& writer, std::size_t symbol) const {
+        if (symbol >= N || lengths_[symbol] == 0) {
+            throw std::runtime_error("Symbol " + std::to_string(symbol) + " not found in code table");
+        }
+        writer.write(reversed_[symbol], lengths_[symbol]);
+    }
+
+    void encodeTo(BitWriter& writer, std::string_view text) const {
+        for (const char ch : text) {
+            writeSymbol(writer, static_cast<unsigned char>(ch));
+        }
+    }
+
+    [[nodiscard]] PackedBits encode(std::string_view text) const {
+        BitWriter writer;
+        writer.reserveBytes(text.size() * TableBits / 8 + 8);
+        encodeTo(writer, text);
+
+        PackedBits packed;
+        packed.bitCount = writer.bitCount();
+        packed.symbolCount = text.size();
+        packed.bytes = writer.finish();
+        return packed;
+    }
+
+    [[nodiscard]] std::uint32_t decodeSymbol(BitReader& reader) const {
+        reader.refill();
+        const Entry entry = table_[reader.peek(TableBits)];
+        if (entry.length == 0) {
+            throw std::runtime_error("Invalid encoded data: no matching code");
+        }
+        if (entry.length > reader.bitsRemaining()) {
+            throw std::runtime_error("Invalid encoded data: unexpected end of stream");
+        }
+        reader.consume(entry.length);
+        return entry.symbol;
+    }
+
+    [[nodiscard]] std::string decode(const PackedBits& packed) const {
+        return decode(packed.bytes, packed.bitCount, packed.symbolCount);
+    }
+
+    // Decodes `symbolCount` bytes; the alphabet must be at most 256 symbols.
+    [[nodiscard]] std::string decode(std::string_view bytes, std::size_t bitCount,
+                                     std::size_t symbolCount) const {
+        static_assert(N <= 256, "byte decoding requires an alphabet of at most 256 symbols");
+        if (bitCount > bytes.size() * 8) {
+            throw std::invalid_argument("Bit range exceeds input size");
+        }
+
+        std::string out(symbolCount, '\0');
+        BitReader reader(bytes, bitCount);
+        std::size_t i = 0;
+
+        // One refill covers kPerRefill lookups; the group is taken only while
+        // even the longest codes stay inside the stream.
+        constexpr std::size_t kPerRefill = 56 / TableBits;
+        while (i + kPerRefill <= symbolCount &&
+               reader.position() + kPerRefill * TableBits <= bitCount) {
+            reader.refill();
+            for (std::size_t k = 0; k < kPerRefill; ++k) {
+                const Entry entry = table_[reader.peek(TableBits)];
+                if (entry.length == 0) {
+                    throw std::runtime_error("Invalid encoded data: no matching code");
+                }
+                out[i++] = static_cast<char>(entry.symbol);
+                reader.consume(entry.length);
+            }
+        }
+        while (i < symbolCount) {
+            out[i++] = static_cast<char>(decodeSymbol(reader));
+        }
+
+        if (reader.bitsRemaining() != 0) {
+            throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+        }
+        return out;
+    }
+
+private:
+    struct Entry {
+        std::uint16_t symbol = 0;
+        std::uint8_t length = 0;  // 0: index is not the prefix of any code
+    };
+
+    std::array<std::uint8_t, N> lengths_{};
+    std::array<std::uint32_t, N> codes_{};
+    std::array<std::uint32_t, N> reversed_{};
+    std::array<Entry, std::size_t{1} << TableBits> table_{};
+};
+
+// Fixed byte code for HTTP header text: lowercase letters and the common
+// separators take 6 bits, other printable ASCII and tab 8, UTF-8
+// continuation and two-byte lead bytes 9, and everything else 10. The
+// lengths form a complete code.
+[[nodiscard]] constexpr std::array<std::uint8_t, 256> headerTextCodeLengths() {
+    std::array<std::uint8_t, 256> lengths{};
+    constexpr std::string_view kSeparators = " -/:.=";
+    for (unsigned b = 0; b < 256; ++b) {
+        std::uint8_t len = 10;
+        if ((b >= 'a' && b <= 'z') || kSeparators.find(static_cast<char>(b)) != std::string_view::npos) {
+            len = 6;
+        } else if ((b >= 0x20 && b <= 0x7E) || b == '\t') {
+            len = 8;
+        } else if (b >= 0x80 && b <= 0xDF) {
+            len = 9;
+        }
+        lengths[b] = len;
+    }
+    return lengths;
+}
+
+inline constexpr StaticCodeTable<256, 10> kHeaderTextCode{headerTextCodeLengths()};
+
+} // namespace huffman
+
+#endif // HUFFMAN_STATIC_CODE_H
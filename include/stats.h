@@ -0,0 +1,113 @@
+#ifndef HUFFMAN_STATS_H
+#define HUFFMAN_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Set by the HUFFMAN_STATS CMake option. When 0 the counters below are
+// empty and every update compiles to nothing.
+#ifndef HUFFMAN_STATS
+#define HUFFMAN_STATS 0
+#endif
+
+namespace huffman {
+
+inline constexpr bool kStatsEnabled = HUFFMAN_STATS != 0;
+
+// Totals accumulated by an encoder or decoder since construction or the
+// last reset. Stage times are wall-clock nanoseconds; stages that run on
+// several threads add up each thread's time.
+struct Stats {
+    std::uint64_t bytesIn = 0;
+    std::uint64_t bytesOut = 0;
+    std::uint64_t blocks = 0;
+    // Blocks that carry a freshly built table, and blocks that repeat the
+    // previous block's table
+    std::uint64_t tablesBuilt = 0;
+    std::uint64_t tablesReused = 0;
+    std::uint64_t storedBlocks = 0;
+    std::uint64_t histogramNs = 0;
+    std::uint64_t buildNs = 0;
+    std::uint64_t encodeNs = 0;
+    std::uint64_t decodeNs = 0;
+
+    Stats& operator+=(const Stats& other) noexcept;
+    // Single-line JSON object with snake_case keys and an "enabled" flag.
+    [[nodiscard]] std::string toJson() const;
+};
+
+enum class Stat : std::size_t {
+    BytesIn,
+    BytesOut,
+    Blocks,
+    TablesBuilt,
+    TablesReused,
+    StoredBlocks,
+    HistogramNs,
+    BuildNs,
+    EncodeNs,
+    DecodeNs,
+    Count,
+};
+
+// Counters that const encode and decode calls update, possibly from several
+// threads at once. Copies take a snapshot of the values.
+class StatsCounters {
+public:
+    StatsCounters() noexcept { reset(); }
+    StatsCounters(const StatsCounters& other) noexcept { copyFrom(other); }
+    StatsCounters& operator=(const StatsCounters& other) noexcept {
+        copyFrom(other);
+        return *this;
+    }
+
+    void add([[maybe_unused]] Stat stat, [[maybe_unused]] std::uint64_t amount) const noexcept {
+#if HUFFMAN_STATS
+        values_[static_cast<std::size_t>(stat)].fetch_add(amount, std::memory_order_relaxed);
+#endif
+    }
+
+    [[nodiscard]] Stats snapshot() const noexcept;
+    void reset() noexcept;
+
+private:
+#if HUFFMAN_STATS
+    mutable std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Stat::Count)> values_;
+#endif
+
+    void copyFrom(const StatsCounters& other) noexcept;
+};
+
+// Adds the time between construction and destruction to a stage counter.
+class StageTimer {
+public:
+#if HUFFMAN_STATS
+    StageTimer(const StatsCounters& counters, Stat stat) noexcept
+        : counters_(counters), stat_(stat), start_(std::chrono::steady_clock::now()) {}
+    ~StageTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        counters_.add(stat_, static_cast<std::uint64_t>(
+                                 std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                                     .count()));
+    }
+#else
+    StageTimer(const StatsCounters&, Stat) noexcept {}
+#endif
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+#if HUFFMAN_STATS
+    const StatsCounters& counters_;
+    Stat stat_;
+    std::chrono::steady_clock::time_point start_;
+#endif
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_STATS_H
@@ -0,0 +1,198 @@
+#ifndef HUFFMAN_STREAM_H
+#define HUFFMAN_STREAM_H
+
+#include "code_table.h"
+#include "context_model.h"
+#include "lz77.h"
+#include "multi_table.h"
+#include "run_length.h"
+#include "stats.h"
+#include "table_decoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Self-contained compressed container: a header followed by independently
+// coded blocks, each carrying its own canonical code lengths.
+//
+//   magic "HUFS", u8 version, u8 flags, u32 blockSize, u64 totalSize,
+//   u32 blockCount
+//   per block:
+//     u8 type, u32 rawSize, tables, u64 bitCount,
+//     u32 syncInterval, u32 syncCount, u64[syncCount] sync bit offsets,
+//     payload (ceil(bitCount / 8) bytes)
+//
+// Tables by block type:
+//   Huffman:        u8[256] code lengths
+//   ContextHuffman: u8 tableCount - 1, u8[256] table per previous byte,
+//                   tableCount x u8[256] code lengths (never has sync points)
+//   Lz77Huffman:    u8[257] literal/match lengths, u8[16] match length code
+//                   lengths, u8[48] distance code lengths (never has sync points)
+//   RunLengthHuffman: u8[258] literal and run token lengths (never has sync
+//                   points)
+//   BwtHuffman:     u32 tokenCount, u8 tableCount, tableCount x u8[258] code
+//                   lengths; the payload holds per-50-token table selectors,
+//                   then zero-run tokens of the BWT + move-to-front output
+//                   (never has sync points)
+//   RepeatHuffman:  no tables; reuses the code lengths of the nearest earlier
+//                   Huffman block (may have sync points)
+//   Stored:         no tables; the payload is the raw block (bitCount is
+//                   8 x rawSize, never has sync points)
+//
+// Sync point i is the bit offset of symbol (i + 1) * syncInterval within the
+// block payload, which lets a decoder split one block across threads.
+//
+// With the block-index flag set, the blocks are followed by
+//   per block: u64 raw offset, u64 stream offset of the block header
+//   u64 index offset, u32 blockCount, magic "HUFX"
+// so that a reader can seek to any uncompressed offset from the end of the
+// stream.
+
+enum class BlockType : std::uint8_t {
+    Huffman = 0,
+    ContextHuffman = 1,
+    Lz77Huffman = 2,
+    RunLengthHuffman = 3,
+    BwtHuffman = 4,
+    Stored = 5,
+    RepeatHuffman = 6,
+};
+
+struct StreamOptions {
+    // Raw bytes per block
+    std::size_t blockSize = std::size_t{1} << 20;
+    // Symbols between sync points; 0 disables the sync-point index
+    std::size_t syncInterval = 0;
+    // Append a trailing block index for random access
+    bool blockIndex = false;
+    // Order-1 context tables per block (up to 256); 0 disables context
+    // modeling. Blocks fall back to a single table when that is smaller.
+    unsigned contextTables = 0;
+    // LZ77 match finding before entropy coding, 1 (fast) to 9 (best);
+    // 0 disables it. Matches never cross block boundaries.
+    unsigned lz77Level = 0;
+    unsigned lz77WindowBits = 15;
+    // Code runs of a repeated byte as run tokens when that is smaller
+    bool runLength = false;
+    // Burrows-Wheeler + move-to-front + zero-run coding with up to six
+    // tables switched every 50 tokens; best ratio on text, slowest to encode
+    bool bwt = false;
+    // Reuse the previous block's table when that codes the block in fewer
+    // bits than a fresh table plus its header
+    bool reuseTables = true;
+};
+
+// Where a block starts in the raw data and in the stream.
+struct BlockLocation {
+    std::uint64_t rawOffset = 0;
+    std::uint64_t streamOffset = 0;
+};
+
+class StreamEncoder {
+public:
+    explicit StreamEncoder(StreamOptions options = {});
+
+    [[nodiscard]] std::string encode(std::string_view input) const;
+    // Appends the stream for `input` to `out`, so a caller can reuse one
+    // buffer across calls.
+    void encodeTo(std::string& out, std::string_view input) const;
+    // Writes the stream for `input` straight into caller memory and returns
+    // its size. Throws std::invalid_argument unless `capacity` is at least
+    // maxEncodedSize(input.size()).
+    std::size_t encodeInto(std::string_view input, char* out, std::size_t capacity) const;
+    // Upper bound on the encoded size of `inputSize` bytes with these options.
+    [[nodiscard]] std::size_t maxEncodedSize(std::size_t inputSize) const noexcept;
+
+    // Stream pieces for callers that code blocks themselves, e.g. on several
+    // threads: the header for `totalSize` raw bytes, then every block in
+    // order, then (with blockIndex) the index, whose offsets are relative to
+    // the start of the header. Blocks coded this way never repeat an
+    // earlier block's table.
+    void appendHeader(std::string& out, std::uint64_t totalSize) const;
+    void appendBlock(std::string& out, std::string_view block) const;
+    void appendIndex(std::string& out, const std::vector<BlockLocation>& blocks,
+                     std::uint64_t indexOffset) const;
+
+    [[nodiscard]] const StreamOptions& options() const noexcept { return options_; }
+
+    // Counters over every call so far; all zero unless built with
+    // HUFFMAN_STATS. bytesOut includes stream headers and indexes.
+    [[nodiscard]] Stats stats() const noexcept { return stats_.snapshot(); }
+    void resetStats() noexcept { stats_.reset(); }
+
+private:
+    StreamOptions options_;
+    StatsCounters stats_;
+
+    // The writers of the final stream take std::string or SpanWriter (see
+    // byte_io.h); candidate blocks are always built in a std::string.
+    template <typename Out>
+    void encodeStream(Out& out, std::string_view input) const;
+    template <typename Out>
+    void writeHeader(Out& out, std::uint64_t totalSize) const;
+    template <typename Out>
+    void writeIndex(Out& out, const std::vector<BlockLocation>& blocks,
+                    std::uint64_t indexOffset) const;
+    template <typename Out>
+    void encodeBlock(Out& out, std::string_view block, std::optional<CodeTable>& previous,
+                     bool blocksFollow) const;
+    template <typename Out>
+    void encodeHuffmanBlock(Out& out, std::string_view block, const CodeTable& table,
+                            BlockType type) const;
+    void encodeContextBlock(std::string& out, std::string_view block,
+                            const ContextModel& model) const;
+    void encodeLz77Block(std::string& out, std::string_view block,
+                         const std::vector<Lz77Token>& tokens, const Lz77Model& model) const;
+    void encodeRunLengthBlock(std::string& out, std::string_view block,
+                              const std::vector<std::uint16_t>& tokens,
+                              const RunLengthModel& model) const;
+    template <typename Out>
+    void encodeStoredBlock(Out& out, std::string_view block) const;
+    void encodeBwtBlock(std::string& out, std::string_view block,
+                        const std::vector<std::uint16_t>& tokens,
+                        const MultiTableModel& model) const;
+};
+
+class StreamDecoder {
+public:
+    // `threads` workers decode blocks, and sync-point segments within blocks,
+    // concurrently; 0 means one per hardware thread. When there are fewer
+    // blocks than workers, blocks without sync points are decoded
+    // speculatively (see decodeSpeculative).
+    explicit StreamDecoder(unsigned threads = 0, DecodeKernel kernel = detectDecodeKernel());
+
+    [[nodiscard]] std::string decode(std::string_view stream) const;
+    // Decodes into caller memory and returns the decoded size; throws
+    // std::invalid_argument if it exceeds `capacity`.
+    std::size_t decodeInto(std::string_view stream, char* out, std::size_t capacity) const;
+    // Uncompressed size recorded in the stream header.
+    [[nodiscard]] static std::uint64_t decodedSize(std::string_view stream);
+
+    // Returns uncompressed bytes [offset, offset + length), decoding only the
+    // blocks that cover them (and, within a block, starting from the nearest
+    // sync point). Uses the block index when present and otherwise skips
+    // over block headers. Throws std::invalid_argument for ranges past the
+    // end of the stream.
+    [[nodiscard]] std::string readAt(std::string_view stream, std::uint64_t offset,
+                                     std::size_t length) const;
+
+    // Counters over decode and decodeInto calls; all zero unless built with
+    // HUFFMAN_STATS.
+    [[nodiscard]] Stats stats() const noexcept { return stats_.snapshot(); }
+    void resetStats() noexcept { stats_.reset(); }
+
+private:
+    unsigned threads_;
+    DecodeKernel kernel_;
+    StatsCounters stats_;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_STREAM_H
@@ -0,0 +1,109 @@
+#ifndef HUFFMAN_TABLE_DECODER_H
+#define HUFFMAN_TABLE_DECODER_H
+
+#include "bitstream.h"
+#include "code_table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+enum class DecodeKernel {
+    Generic,
+    Bmi2,
+};
+
+// Best decode kernel supported by the running CPU.
+[[nodiscard]] DecodeKernel detectDecodeKernel() noexcept;
+[[nodiscard]] bool isKernelSupported(DecodeKernel kernel) noexcept;
+[[nodiscard]] const char* kernelName(DecodeKernel kernel) noexcept;
+
+struct TableDecoderOptions {
+    // Width of the lookup index in bits; codes longer than this are resolved
+    // canonically one bit at a time.
+    unsigned tableBits = 11;
+    // Upper bound on symbols emitted per lookup (1..4). Values above 1 only
+    // take effect for byte alphabets.
+    unsigned maxSymbolsPerEntry = 4;
+};
+
+// Table-driven decoder for bit-packed canonical codes. Each table entry holds
+// every symbol whose codes fit entirely in the lookup index, so short codes
+// decode several bytes per lookup.
+class TableDecoder {
+public:
+    explicit TableDecoder(const CodeTable& table, TableDecoderOptions options = {});
+
+    [[nodiscard]] std::string decode(const PackedBits& packed) const;
+    [[nodiscard]] std::string decode(std::string_view bytes, std::size_t bitCount,
+                                     std::size_t symbolCount) const;
+    // Decodes with a specific kernel; throws std::invalid_argument if the CPU
+    // does not support it.
+    [[nodiscard]] std::string decode(std::string_view bytes, std::size_t bitCount,
+                                     std::size_t symbolCount, DecodeKernel kernel) const;
+
+    // Decodes exactly `symbolCount` bytes from bits [bitBegin, bitEnd) of
+    // `bytes` into `out`. Never writes outside out[0, symbolCount), so
+    // disjoint ranges of one buffer can be filled concurrently.
+    void decodeInto(char* out, std::size_t symbolCount, std::string_view bytes,
+                    std::size_t bitBegin, std::size_t bitEnd, DecodeKernel kernel) const;
+
+    // Decodes whole symbols into `out` until the reader reaches `stopBit` or
+    // `capacity` symbols have been written; returns the number written. The
+    // last symbol may end past `stopBit`.
+    [[nodiscard]] std::size_t decodeUntil(BitReader& reader, char* out, std::size_t capacity,
+                                          std::size_t stopBit, DecodeKernel kernel) const;
+
+    // Decodes a single symbol of any alphabet size.
+    [[nodiscard]] std::uint32_t decodeSymbol(BitReader& reader) const;
+
+    [[nodiscard]] unsigned tableBits() const noexcept { return tableBits_; }
+    [[nodiscard]] unsigned maxSymbolsPerEntry() const noexcept { return maxSymbols_; }
+
+private:
+    struct Entry {
+        std::uint32_t symbols = 0;  // Up to four bytes, first symbol lowest
+        std::uint8_t count = 0;     // 0: no complete code in the index bits
+        std::uint8_t length = 0;    // Bits consumed by all symbols
+    };
+
+    std::vector<Entry> table_;
+    std::vector<std::uint16_t> counts_;
+    std::vector<std::uint16_t> sorted_;
+    // Canonical resolution by comparison, in 16-bit left-aligned units
+    std::vector<std::uint32_t> firstCode_;
+    std::vector<std::uint32_t> limit_;
+    std::vector<std::uint16_t> offset_;
+    // Shortest possible code length given the number of leading one bits
+    std::vector<std::uint8_t> startLength_;
+    unsigned tableBits_;
+    unsigned maxSymbols_;
+    unsigned maxLength_;
+    std::size_t alphabetSize_;
+
+    // Canonical bit-at-a-time decode of the code at the front of `window`;
+    // returns the code length, or 0 if no code of at most `limit` bits matches.
+    [[nodiscard]] unsigned decodeCanonical(std::uint64_t window, unsigned limit,
+                                           std::uint32_t& symbol) const noexcept;
+    // Same result as decodeCanonical over maxLength_ bits, but skips straight
+    // to the first feasible length using the count of leading one bits.
+    [[nodiscard]] unsigned decodeCanonicalHinted(std::uint64_t window,
+                                                 std::uint32_t& symbol) const noexcept;
+
+    // Bulk decode while the output has room and the reader is comfortably
+    // before `stopBit`; `dst` is advanced. Both kernels run this same loop
+    // and differ only in the instructions it is compiled to.
+    void decodeFast(BitReader& reader, char*& dst, char* end, std::size_t stopBit) const;
+    void decodeFastGeneric(BitReader& reader, char*& dst, char* end, std::size_t stopBit) const;
+    void decodeFastBmi2(BitReader& reader, char*& dst, char* end, std::size_t stopBit) const;
+    void decodeFastDispatch(BitReader& reader, char*& dst, char* end, std::size_t stopBit,
+                            DecodeKernel kernel) const;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_TABLE_DECODER_H
@@ -0,0 +1,41 @@
+#ifndef HUFFMAN_TRANSFORM_H
+#define HUFFMAN_TRANSFORM_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace huffman {
+
+// Replaces each byte with its position in a recency list, so the runs of
+// equal bytes a BWT produces become runs of zeros.
+[[nodiscard]] std::string moveToFront(std::string_view data);
+[[nodiscard]] std::string inverseMoveToFront(std::string_view data);
+
+// Reversible byte-to-byte stages that can be chained ahead of entropy
+// coding. Side information a stage needs (the BWT primary index) is stored
+// inline as a 4-byte little-endian prefix.
+enum class TransformStage {
+    Bwt,
+    MoveToFront,
+};
+
+class TransformPipeline {
+public:
+    explicit TransformPipeline(std::vector<TransformStage> stages);
+
+    // Runs the stages in order.
+    [[nodiscard]] std::string forward(std::string_view data) const;
+    // Undoes the stages in reverse order; throws std::runtime_error on
+    // malformed input.
+    [[nodiscard]] std::string inverse(std::string_view data) const;
+
+    [[nodiscard]] const std::vector<TransformStage>& stages() const noexcept { return stages_; }
+
+private:
+    std::vector<TransformStage> stages_;
+};
+
+} // namespace huffman
+
+#endif // HUFFMAN_TRANSFORM_H
@@ -0,0 +1,191 @@
+#include "adaptive.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace huffman {
+
+AdaptiveHuffmanTree::AdaptiveHuffmanTree() {
+    reset();
+}
+
+void AdaptiveHuffmanTree::reset() {
+    nodes_.assign(kMaxNodes, Node{});
+    leafOf_.fill(-1);
+    nyt_ = kRoot;
+    path_.clear();
+    path_.reserve(kMaxNodes);
+}
+
+void AdaptiveHuffmanTree::writePath(int node, BitWriter& writer) {
+    path_.clear();
+    while (node != kRoot) {
+        const int parent = nodes_[static_cast<std::size_t>(node)].parent;
+        path_.push_back(nodes_[static_cast<std::size_t>(parent)].right == node ? 1 : 0);
+        node = parent;
+    }
+
+    // Root-first, packed into writes of up to 32 bits
+    std::uint32_t bits = 0;
+    unsigned count = 0;
+    for (auto it = path_.rbegin(); it != path_.rend(); ++it) {
+        bits |= static_cast<std::uint32_t>(*it) << count;
+        if (++count == 32) {
+            writer.write(bits, count);
+            bits = 0;
+            count = 0;
+        }
+    }
+    if (count != 0) {
+        writer.write(bits, count);
+    }
+}
+
+void AdaptiveHuffmanTree::encodeSymbol(unsigned char symbol, BitWriter& writer) {
+    const int leaf = leafOf_[symbol];
+    if (leaf >= 0) {
+        writePath(leaf, writer);
+    } else {
+        writePath(nyt_, writer);
+        writer.write(symbol, 8);
+    }
+    update(symbol);
+}
+
+unsigned char AdaptiveHuffmanTree::decodeSymbol(BitReader& reader) {
+    reader.refill();
+    int node = kRoot;
+    unsigned buffered = 56;
+    while (nodes_[static_cast<std::size_t>(node)].left != -1) {
+        if (reader.bitsRemaining() == 0) {
+            throw std::runtime_error("Invalid encoded data: unexpected end of stream");
+        }
+        if (buffered == 0) {
+            reader.refill();
+            buffered = 56;
+        }
+        const Node& current = nodes_[static_cast<std::size_t>(node)];
+        node = reader.peek(1) != 0 ? current.right : current.left;
+        reader.consume(1);
+        --buffered;
+    }
+
+    unsigned char symbol;
+    if (node == nyt_) {
+        reader.refill();
+        if (reader.bitsRemaining() < 8) {
+            throw std::runtime_error("Invalid encoded data: unexpected end of stream");
+        }
+        symbol = static_cast<unsigned char>(reader.peek(8));
+        reader.consume(8);
+    } else {
+        symbol = static_cast<unsigned char>(nodes_[static_cast<std::size_t>(node)].symbol);
+    }
+    update(symbol);
+    return symbol;
+}
+
+void AdaptiveHuffmanTree::swapNodes(int a, int b) {
+    Node& na = nodes_[static_cast<std::size_t>(a)];
+    Node& nb = nodes_[static_cast<std::size_t>(b)];
+    std::swap(na.weight, nb.weight);
+    std::swap(na.left, nb.left);
+    std::swap(na.right, nb.right);
+    std::swap(na.symbol, nb.symbol);
+
+    // Positions keep their parents; re-point whatever moved into them
+    for (int index : {a, b}) {
+        const Node& node = nodes_[static_cast<std::size_t>(index)];
+        if (node.left != -1) {
+            nodes_[static_cast<std::size_t>(node.left)].parent = index;
+            nodes_[static_cast<std::size_t>(node.right)].parent = index;
+        } else if (node.symbol >= 0) {
+            leafOf_[static_cast<std::size_t>(node.symbol)] = index;
+        } else {
+            nyt_ = index;
+        }
+    }
+}
+
+void AdaptiveHuffmanTree::update(unsigned char symbol) {
+    int q = leafOf_[symbol];
+    if (q < 0) {
+        // Split the NYT leaf into a new NYT and a leaf for `symbol`
+        const int parent = nyt_;
+        const int leaf = parent - 1;
+        const int nyt = parent - 2;
+        Node& split = nodes_[static_cast<std::size_t>(parent)];
+        split.left = nyt;
+        split.right = leaf;
+        split.symbol = -1;
+        nodes_[static_cast<std::size_t>(leaf)] = Node{0, parent, -1, -1, symbol};
+        nodes_[static_cast<std::size_t>(nyt)] = Node{0, parent, -1, -1, -1};
+        leafOf_[symbol] = leaf;
+        nyt_ = nyt;
+        q = leaf;
+    }
+
+    while (q != -1) {
+        // Swap with the highest-numbered node of equal weight (the block
+        // leader) to keep the sibling property, unless that is the parent
+        const std::uint64_t weight = nodes_[static_cast<std::size_t>(q)].weight;
+        int leader = q;
+        while (leader < kRoot && nodes_[static_cast<std::size_t>(leader + 1)].weight == weight) {
+            ++leader;
+        }
+        if (leader != q && leader != nodes_[static_cast<std::size_t>(q)].parent) {
+            swapNodes(q, leader);
+            q = leader;
+        }
+        ++nodes_[static_cast<std::size_t>(q)].weight;
+        q = nodes_[static_cast<std::size_t>(q)].parent;
+    }
+}
+
+void AdaptiveHuffmanEncoder::encode(std::string_view data) {
+    for (char ch : data) {
+        tree_.encodeSymbol(static_cast<unsigned char>(ch), writer_);
+    }
+    symbols_ += data.size();
+}
+
+std::string AdaptiveHuffmanEncoder::takeBytes() {
+    return writer_.drainBytes();
+}
+
+PackedBits AdaptiveHuffmanEncoder::finish() {
+    PackedBits packed;
+    packed.bitCount = writer_.bitCount();
+    packed.symbolCount = symbols_;
+    packed.bytes = writer_.finish();
+
+    tree_.reset();
+    writer_ = BitWriter();
+    symbols_ = 0;
+    return packed;
+}
+
+std::string AdaptiveHuffmanDecoder::decode(const PackedBits& packed) const {
+    return decode(packed.bytes, packed.bitCount, packed.symbolCount);
+}
+
+std::string AdaptiveHuffmanDecoder::decode(std::string_view bytes, std::size_t bitCount,
+                                           std::size_t symbolCount) const {
+    if (bitCount > bytes.size() * 8) {
+        throw std::invalid_argument("Bit count exceeds input size");
+    }
+
+    AdaptiveHuffmanTree tree;
+    BitReader reader(bytes, bitCount);
+    std::string out;
+    out.reserve(symbolCount);
+    for (std::size_t i = 0; i < symbolCount; ++i) {
+        out.push_back(static_cast<char>(tree.decodeSymbol(reader)));
+    }
+    if (reader.bitsRemaining() != 0) {
+        throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+    }
+    return out;
+}
+
+} // namespace huffman
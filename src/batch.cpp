@@ -0,0 +1,128 @@
+#include "batch.h"
+
+#include "bitstream.h"
+#include "histogram.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+void checkOffsets(const EncodedBatch& batch) {
+    const auto& bits = batch.bitOffsets;
+    const auto& raw = batch.rawOffsets;
+    if (bits.empty() || bits.size() != raw.size() || bits.front() != 0 || raw.front() != 0 ||
+        !std::is_sorted(bits.begin(), bits.end()) || !std::is_sorted(raw.begin(), raw.end()) ||
+        bits.back() > std::uint64_t{8} * batch.bytes.size()) {
+        throw std::invalid_argument("Batch offsets are inconsistent");
+    }
+}
+
+} // namespace
+
+BatchEncoder::BatchEncoder(CodeTable table) : table_(std::move(table)) {
+    if (table_.empty() || table_.alphabetSize() > 256) {
+        throw std::invalid_argument("Batch coding requires a non-empty byte-alphabet table");
+    }
+}
+
+CodeTable BatchEncoder::train(const std::vector<std::string_view>& messages) {
+    // Start every byte at one so the table is total
+    std::vector<std::uint64_t> frequencies(256, 1);
+    for (std::string_view message : messages) {
+        const Histogram histogram = computeHistogram(message);
+        for (std::size_t b = 0; b < histogram.size(); ++b) {
+            frequencies[b] += histogram[b];
+        }
+    }
+    return CodeTable::fromFrequencies(frequencies);
+}
+
+EncodedBatch BatchEncoder::encode(const std::string_view* messages, std::size_t count) const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        total += messages[i].size();
+    }
+
+    EncodedBatch batch;
+    batch.bitOffsets.reserve(count + 1);
+    batch.rawOffsets.reserve(count + 1);
+    BitWriter writer;
+    writer.reserveBytes(total * table_.maxLength() / 8 + 8);
+    std::uint64_t raw = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        table_.encodeTo(writer, messages[i]);
+        raw += messages[i].size();
+        batch.bitOffsets.push_back(writer.bitCount());
+        batch.rawOffsets.push_back(raw);
+    }
+    batch.bytes = writer.finish();
+    return batch;
+}
+
+EncodedBatch BatchEncoder::encode(const MessageArena& messages) const {
+    std::vector<std::string_view> views;
+    views.reserve(messages.size());
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        views.push_back(messages[i]);
+    }
+    return encode(views);
+}
+
+BatchDecoder::BatchDecoder(const CodeTable& table, unsigned threads)
+    : decoder_(table), threads_(threads), kernel_(detectDecodeKernel()) {
+    if (table.alphabetSize() > 256) {
+        throw std::invalid_argument("Batch coding requires a byte-alphabet table");
+    }
+}
+
+MessageArena BatchDecoder::decode(const EncodedBatch& batch) const {
+    checkOffsets(batch);
+    const auto& bits = batch.bitOffsets;
+    const auto& raw = batch.rawOffsets;
+
+    MessageArena arena;
+    arena.data.assign(static_cast<std::size_t>(raw.back()), '\0');
+    arena.offsets = raw;
+
+    // Messages are contiguous in both the bits and the output, so each
+    // worker decodes a run of them in one call, split at message bounds.
+    const std::size_t count = batch.size();
+    const std::size_t workers = std::min<std::size_t>(resolveThreadCount(threads_), count);
+    std::vector<std::size_t> bounds{0};
+    for (std::size_t w = 1; w < workers; ++w) {
+        const std::uint64_t target = raw.back() * w / workers;
+        const auto it = std::lower_bound(raw.begin(), raw.end(), target);
+        bounds.push_back(std::max(bounds.back(), static_cast<std::size_t>(it - raw.begin())));
+    }
+    bounds.push_back(count);
+
+    parallelFor(bounds.size() - 1, threads_, [&](std::size_t g) {
+        const std::size_t first = bounds[g];
+        const std::size_t last = bounds[g + 1];
+        if (first == last) return;
+        decoder_.decodeInto(arena.data.data() + raw[first],
+                            static_cast<std::size_t>(raw[last] - raw[first]), batch.bytes,
+                            static_cast<std::size_t>(bits[first]),
+                            static_cast<std::size_t>(bits[last]), kernel_);
+    });
+    return arena;
+}
+
+std::string BatchDecoder::decodeMessage(const EncodedBatch& batch, std::size_t index) const {
+    checkOffsets(batch);
+    if (index >= batch.size()) {
+        throw std::invalid_argument("Message index out of range");
+    }
+    const auto& raw = batch.rawOffsets;
+    std::string out(static_cast<std::size_t>(raw[index + 1] - raw[index]), '\0');
+    decoder_.decodeInto(out.data(), out.size(), batch.bytes,
+                        static_cast<std::size_t>(batch.bitOffsets[index]),
+                        static_cast<std::size_t>(batch.bitOffsets[index + 1]), kernel_);
+    return out;
+}
+
+} // namespace huffman
@@ -0,0 +1,191 @@
+#include "bwt.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+// SA-IS over integer symbols in [0, upper]: sort LMS substrings by induced
+// sorting, rename them, recurse if names repeat, then induce the full order.
+std::vector<int> suffixArrayIs(const std::vector<int>& s, int upper) {
+    const int n = static_cast<int>(s.size());
+    if (n == 0) return {};
+    if (n == 1) return {0};
+    if (n == 2) return s[0] < s[1] ? std::vector<int>{0, 1} : std::vector<int>{1, 0};
+
+    auto at = [](auto& v, int i) -> decltype(auto) { return v[static_cast<std::size_t>(i)]; };
+
+    std::vector<int> sa(static_cast<std::size_t>(n));
+    std::vector<bool> isS(static_cast<std::size_t>(n));
+    for (int i = n - 2; i >= 0; --i) {
+        at(isS, i) = at(s, i) == at(s, i + 1) ? static_cast<bool>(at(isS, i + 1))
+                                              : at(s, i) < at(s, i + 1);
+    }
+
+    // Bucket starts for L-type (sumL) and S-type (sumS) suffixes
+    std::vector<int> sumL(static_cast<std::size_t>(upper) + 1, 0);
+    std::vector<int> sumS(static_cast<std::size_t>(upper) + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        if (!at(isS, i)) {
+            ++at(sumS, at(s, i));
+        } else {
+            ++at(sumL, at(s, i) + 1);
+        }
+    }
+    for (int c = 0; c <= upper; ++c) {
+        at(sumS, c) += at(sumL, c);
+        if (c < upper) at(sumL, c + 1) += at(sumS, c);
+    }
+
+    auto induce = [&](const std::vector<int>& lms) {
+        std::fill(sa.begin(), sa.end(), -1);
+        std::vector<int> bucket(sumS);
+        for (int d : lms) {
+            if (d != n) sa[static_cast<std::size_t>(at(bucket, at(s, d))++)] = d;
+        }
+        bucket = sumL;
+        sa[static_cast<std::size_t>(at(bucket, at(s, n - 1))++)] = n - 1;
+        for (int i = 0; i < n; ++i) {
+            const int v = at(sa, i);
+            if (v >= 1 && !at(isS, v - 1)) {
+                sa[static_cast<std::size_t>(at(bucket, at(s, v - 1))++)] = v - 1;
+            }
+        }
+        bucket = sumL;
+        for (int i = n - 1; i >= 0; --i) {
+            const int v = at(sa, i);
+            if (v >= 1 && at(isS, v - 1)) {
+                sa[static_cast<std::size_t>(--at(bucket, at(s, v - 1) + 1))] = v - 1;
+            }
+        }
+    };
+
+    std::vector<int> lmsIndex(static_cast<std::size_t>(n) + 1, -1);
+    std::vector<int> lms;
+    for (int i = 1; i < n; ++i) {
+        if (!at(isS, i - 1) && at(isS, i)) {
+            at(lmsIndex, i) = static_cast<int>(lms.size());
+            lms.push_back(i);
+        }
+    }
+    const int m = static_cast<int>(lms.size());
+    induce(lms);
+    if (m == 0) return sa;
+
+    std::vector<int> sortedLms;
+    sortedLms.reserve(lms.size());
+    for (int v : sa) {
+        if (at(lmsIndex, v) != -1) sortedLms.push_back(v);
+    }
+
+    // Name LMS substrings; equal substrings share a name
+    std::vector<int> reduced(static_cast<std::size_t>(m));
+    int names = 0;
+    at(reduced, at(lmsIndex, sortedLms[0])) = 0;
+    for (int i = 1; i < m; ++i) {
+        int l = at(sortedLms, i - 1);
+        int r = at(sortedLms, i);
+        const int endL = at(lmsIndex, l) + 1 < m ? at(lms, at(lmsIndex, l) + 1) : n;
+        const int endR = at(lmsIndex, r) + 1 < m ? at(lms, at(lmsIndex, r) + 1) : n;
+        bool same = endL - l == endR - r;
+        if (same) {
+            while (l < endL && at(s, l) == at(s, r)) {
+                ++l;
+                ++r;
+            }
+            if (l == n || at(s, l) != at(s, r)) same = false;
+        }
+        if (!same) ++names;
+        at(reduced, at(lmsIndex, at(sortedLms, i))) = names;
+    }
+
+    const std::vector<int> reducedSa = suffixArrayIs(reduced, names);
+    for (int i = 0; i < m; ++i) {
+        at(sortedLms, i) = at(lms, at(reducedSa, i));
+    }
+    induce(sortedLms);
+    return sa;
+}
+
+} // namespace
+
+std::vector<std::uint32_t> buildSuffixArray(std::string_view data) {
+    if (data.size() >= static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        throw std::invalid_argument("Input too large for suffix array construction");
+    }
+    std::vector<int> symbols(data.size());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        symbols[i] = static_cast<unsigned char>(data[i]);
+    }
+    const std::vector<int> sa = suffixArrayIs(symbols, 255);
+    return std::vector<std::uint32_t>(sa.begin(), sa.end());
+}
+
+BwtBlock bwtForward(std::string_view data) {
+    BwtBlock block;
+    if (data.empty()) {
+        return block;
+    }
+    // Rows of data + sentinel: the sentinel-only suffix sorts first and is
+    // preceded by the last byte; the row for suffix 0 holds the sentinel.
+    const std::vector<std::uint32_t> sa = buildSuffixArray(data);
+    block.data.reserve(data.size());
+    block.data.push_back(data.back());
+    for (std::size_t i = 0; i < sa.size(); ++i) {
+        if (sa[i] == 0) {
+            block.primaryIndex = static_cast<std::uint32_t>(i + 1);
+        } else {
+            block.data.push_back(data[sa[i] - 1]);
+        }
+    }
+    return block;
+}
+
+std::string bwtInverse(std::string_view data, std::uint32_t primaryIndex) {
+    const std::size_t n = data.size();
+    if (n == 0) {
+        if (primaryIndex != 0) throw std::runtime_error("Invalid BWT primary index");
+        return {};
+    }
+    if (primaryIndex == 0 || primaryIndex > n) {
+        throw std::runtime_error("Invalid BWT primary index");
+    }
+
+    // Row r of the last column, with the sentinel reinserted at primaryIndex
+    auto lastColumn = [&](std::size_t row) {
+        return static_cast<unsigned char>(data[row < primaryIndex ? row : row - 1]);
+    };
+
+    // First row of each byte in the sorted first column (row 0 is the sentinel)
+    std::array<std::uint32_t, 257> start{};
+    for (char ch : data) ++start[static_cast<unsigned char>(ch) + 1u];
+    start[0] = 1;
+    for (std::size_t c = 1; c < start.size(); ++c) start[c] += start[c - 1];
+
+    // LF mapping: the row holding the rotation one step earlier
+    std::vector<std::uint32_t> lf(n + 1);
+    for (std::size_t row = 0; row <= n; ++row) {
+        if (row == primaryIndex) {
+            lf[row] = 0;
+            continue;
+        }
+        lf[row] = start[lastColumn(row)]++;
+    }
+
+    std::string out(n, '\0');
+    std::size_t row = 0;
+    for (std::size_t i = n; i-- > 0;) {
+        if (row == primaryIndex) {
+            throw std::runtime_error("Invalid BWT primary index");
+        }
+        out[i] = static_cast<char>(lastColumn(row));
+        row = lf[row];
+    }
+    return out;
+}
+
+} // namespace huffman
@@ -0,0 +1,198 @@
+#include "code_table.h"
+
+#include "bitstream.h"
+#include "huffman.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace huffman {
+
+void limitCodeLengths(std::vector<std::uint8_t>& lengths, unsigned maxLength) {
+    // Kraft sum measured in units of 2^-maxLength
+    std::uint64_t kraft = 0;
+    const std::uint64_t capacity = std::uint64_t{1} << maxLength;
+    for (auto& len : lengths) {
+        if (len > maxLength) {
+            len = static_cast<std::uint8_t>(maxLength);
+        }
+        if (len > 0) {
+            kraft += std::uint64_t{1} << (maxLength - len);
+        }
+    }
+
+    // Lengthen the longest codes that can still grow until the code fits.
+    // Each step frees the smallest possible share of the code space.
+    while (kraft > capacity) {
+        std::size_t best = lengths.size();
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            if (lengths[i] > 0 && lengths[i] < maxLength &&
+                (best == lengths.size() || lengths[i] > lengths[best])) {
+                best = i;
+            }
+        }
+        if (best == lengths.size()) {
+            throw std::invalid_argument("Too many symbols for the maximum code length");
+        }
+        ++lengths[best];
+        kraft -= std::uint64_t{1} << (maxLength - lengths[best]);
+    }
+}
+
+std::vector<std::uint8_t> buildCodeLengths(const std::vector<std::uint64_t>& frequencies,
+                                           unsigned maxLength) {
+    std::vector<std::uint8_t> lengths(frequencies.size(), 0);
+    std::vector<std::size_t> used;
+    for (std::size_t sym = 0; sym < frequencies.size(); ++sym) {
+        if (frequencies[sym] != 0) used.push_back(sym);
+    }
+    if (used.empty()) {
+        return lengths;
+    }
+    if (used.size() == 1) {
+        lengths[used[0]] = 1;
+        return lengths;
+    }
+
+    // Two-queue Huffman construction: leaves sorted by weight, internal
+    // nodes are created in non-decreasing weight order.
+    std::stable_sort(used.begin(), used.end(), [&](std::size_t a, std::size_t b) {
+        return frequencies[a] < frequencies[b];
+    });
+    const std::size_t leaves = used.size();
+    std::vector<std::uint64_t> weight(2 * leaves - 1);
+    std::vector<std::size_t> parent(2 * leaves - 1, 0);
+    for (std::size_t i = 0; i < leaves; ++i) {
+        weight[i] = frequencies[used[i]];
+    }
+    std::size_t nextLeaf = 0;
+    std::size_t nextInternal = leaves;
+    auto takeSmallest = [&](std::size_t created) {
+        if (nextLeaf < leaves &&
+            (nextInternal >= created || weight[nextLeaf] <= weight[nextInternal])) {
+            return nextLeaf++;
+        }
+        return nextInternal++;
+    };
+    for (std::size_t node = leaves; node < weight.size(); ++node) {
+        const std::size_t a = takeSmallest(node);
+        const std::size_t b = takeSmallest(node);
+        weight[node] = weight[a] + weight[b];
+        parent[a] = node;
+        parent[b] = node;
+    }
+
+    // Depths from the root (the last node) downwards
+    std::vector<unsigned> depth(weight.size(), 0);
+    for (std::size_t node = weight.size() - 1; node-- > 0;) {
+        depth[node] = depth[parent[node]] + 1;
+    }
+    for (std::size_t i = 0; i < leaves; ++i) {
+        lengths[used[i]] = static_cast<std::uint8_t>(std::min(depth[i], 255u));
+    }
+    limitCodeLengths(lengths, maxLength);
+    return lengths;
+}
+
+CodeTable::CodeTable(std::vector<std::uint8_t> lengths)
+    : lengths_(std::move(lengths)) {
+    if (lengths_.size() > 0x10000) {
+        throw std::invalid_argument("Alphabet too large for a code table");
+    }
+
+    counts_.assign(kMaxCodeLength + 1, 0);
+    for (auto len : lengths_) {
+        if (len > kMaxCodeLength) {
+            throw std::invalid_argument("Code length exceeds maximum");
+        }
+        if (len > 0) {
+            ++counts_[len];
+            maxLength_ = std::max<unsigned>(maxLength_, len);
+        }
+    }
+
+    // Reject over-subscribed length sets; under-full sets are allowed so that
+    // a lone symbol can use a one-bit code.
+    std::int64_t left = 1;
+    for (unsigned len = 1; len <= kMaxCodeLength; ++len) {
+        left <<= 1;
+        left -= counts_[len];
+        if (left < 0) {
+            throw std::invalid_argument("Code lengths over-subscribe the code space");
+        }
+    }
+
+    // First canonical code of each length
+    std::vector<std::uint32_t> nextCode(kMaxCodeLength + 2, 0);
+    std::uint32_t code = 0;
+    for (unsigned len = 1; len <= kMaxCodeLength; ++len) {
+        code = (code + counts_[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    codes_.assign(lengths_.size(), Code{});
+    reversed_.assign(lengths_.size(), 0);
+    for (std::size_t sym = 0; sym < lengths_.size(); ++sym) {
+        const unsigned len = lengths_[sym];
+        if (len == 0) continue;
+        codes_[sym] = Code{nextCode[len]++, static_cast<std::uint8_t>(len)};
+        reversed_[sym] = reverseBits(codes_[sym].bits, len);
+    }
+
+    sorted_.reserve(lengths_.size());
+    for (unsigned len = 1; len <= maxLength_; ++len) {
+        for (std::size_t sym = 0; sym < lengths_.size(); ++sym) {
+            if (lengths_[sym] == len) {
+                sorted_.push_back(static_cast<std::uint16_t>(sym));
+            }
+        }
+    }
+}
+
+CodeTable CodeTable::fromTree(const HuffmanTree& tree) {
+    if (!tree.isBuilt()) {
+        throw std::runtime_error("Tree not built. Call buildTree first.");
+    }
+
+    std::vector<std::uint8_t> lengths(256, 0);
+    const CodeArray& codes = tree.getCodes();
+    for (std::size_t b = 0; b < codes.size(); ++b) {
+        lengths[b] = codes[b].length;
+    }
+    limitCodeLengths(lengths, kMaxCodeLength);
+    return CodeTable(std::move(lengths));
+}
+
+CodeTable CodeTable::fromFrequencies(const std::vector<std::uint64_t>& frequencies) {
+    return CodeTable(buildCodeLengths(frequencies, kMaxCodeLength));
+}
+
+PackedBits CodeTable::encode(std::string_view text) const {
+    if (empty()) {
+        throw std::runtime_error("Code table is empty");
+    }
+
+    BitWriter writer;
+    writer.reserveBytes(text.size() * maxLength_ / 8 + 8);
+    encodeTo(writer, text);
+
+    PackedBits packed;
+    packed.bitCount = writer.bitCount();
+    packed.symbolCount = text.size();
+    packed.bytes = writer.finish();
+    return packed;
+}
+
+void CodeTable::encodeTo(BitWriter& writer, std::string_view text) const {
+    for (char ch : text) {
+        const auto sym = static_cast<unsigned char>(ch);
+        const unsigned len = sym < lengths_.size() ? lengths_[sym] : 0;
+        if (len == 0) {
+            throw std::runtime_error(
+                std::string("Character '") + ch + "' not found in code table");
+        }
+        writer.write(reversed_[sym], len);
+    }
+}
+
+} // namespace huffman
@@ -0,0 +1,179 @@
+#include "context_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+using Counts = std::vector<std::uint64_t>;
+
+constexpr int kClusterIterations = 8;
+
+// Estimated cost in bits of one symbol under a cluster's statistics; the
+// additive smoothing keeps symbols the cluster has not seen finite.
+std::vector<double> symbolCosts(const Counts& cluster) {
+    std::uint64_t total = 0;
+    for (auto n : cluster) total += n;
+    std::vector<double> costs(256);
+    const double denominator = static_cast<double>(total) + 128.0;
+    for (std::size_t s = 0; s < 256; ++s) {
+        costs[s] = std::log2(denominator / (static_cast<double>(cluster[s]) + 0.5));
+    }
+    return costs;
+}
+
+} // namespace
+
+ContextModel::ContextModel(std::array<std::uint8_t, 256> tableOf, std::vector<CodeTable> tables)
+    : tableOf_(tableOf), tables_(std::move(tables)) {
+    if (tables_.empty() || tables_.size() > kMaxTables) {
+        throw std::invalid_argument("Context model needs between 1 and 256 tables");
+    }
+    for (auto t : tableOf_) {
+        if (t >= tables_.size()) {
+            throw std::invalid_argument("Context maps to a missing table");
+        }
+    }
+    for (const auto& table : tables_) {
+        if (table.alphabetSize() != 256) {
+            throw std::invalid_argument("Context tables must cover the byte alphabet");
+        }
+    }
+}
+
+ContextModel ContextModel::build(std::string_view data, unsigned maxTables) {
+    if (maxTables == 0 || maxTables > kMaxTables) {
+        throw std::invalid_argument("Context table count must be between 1 and 256");
+    }
+
+    std::vector<Counts> contexts(256, Counts(256, 0));
+    std::vector<std::uint64_t> contextTotals(256, 0);
+    unsigned char prev = 0;
+    for (char ch : data) {
+        const auto cur = static_cast<unsigned char>(ch);
+        ++contexts[prev][cur];
+        ++contextTotals[prev];
+        prev = cur;
+    }
+
+    std::vector<std::size_t> active;
+    for (std::size_t c = 0; c < 256; ++c) {
+        if (contextTotals[c] != 0) active.push_back(c);
+    }
+    std::stable_sort(active.begin(), active.end(), [&](std::size_t a, std::size_t b) {
+        return contextTotals[a] > contextTotals[b];
+    });
+
+    // k-means style clustering seeded with the busiest contexts: assign each
+    // context to the cluster that codes it cheapest, then recompute.
+    const std::size_t clusterCount = std::max<std::size_t>(1, std::min<std::size_t>(maxTables, active.size()));
+    std::vector<Counts> clusters(clusterCount, Counts(256, 0));
+    for (std::size_t k = 0; k < clusterCount && k < active.size(); ++k) {
+        clusters[k] = contexts[active[k]];
+    }
+    std::vector<std::size_t> assignment(256, 0);
+    for (int iteration = 0; iteration < kClusterIterations; ++iteration) {
+        std::vector<std::vector<double>> costs;
+        costs.reserve(clusterCount);
+        for (const auto& cluster : clusters) {
+            costs.push_back(symbolCosts(cluster));
+        }
+
+        bool changed = false;
+        for (std::size_t c : active) {
+            std::size_t best = 0;
+            double bestCost = std::numeric_limits<double>::infinity();
+            for (std::size_t k = 0; k < clusterCount; ++k) {
+                double cost = 0.0;
+                for (std::size_t s = 0; s < 256; ++s) {
+                    if (contexts[c][s] != 0) {
+                        cost += static_cast<double>(contexts[c][s]) * costs[k][s];
+                    }
+                }
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    best = k;
+                }
+            }
+            changed = changed || assignment[c] != best;
+            assignment[c] = best;
+        }
+
+        for (auto& cluster : clusters) {
+            std::fill(cluster.begin(), cluster.end(), 0);
+        }
+        for (std::size_t c : active) {
+            for (std::size_t s = 0; s < 256; ++s) {
+                clusters[assignment[c]][s] += contexts[c][s];
+            }
+        }
+        if (!changed && iteration > 0) break;
+    }
+
+    // Drop clusters that ended up empty and renumber the rest
+    std::vector<std::size_t> renumber(clusterCount, 0);
+    std::vector<CodeTable> tables;
+    for (std::size_t k = 0; k < clusterCount; ++k) {
+        std::uint64_t total = 0;
+        for (auto n : clusters[k]) total += n;
+        if (total == 0 && !(k == 0 && active.empty())) continue;
+        renumber[k] = tables.size();
+        tables.push_back(total == 0 ? CodeTable(std::vector<std::uint8_t>(256, 0))
+                                    : CodeTable::fromFrequencies(clusters[k]));
+    }
+
+    std::array<std::uint8_t, 256> tableOf{};
+    for (std::size_t c : active) {
+        tableOf[c] = static_cast<std::uint8_t>(renumber[assignment[c]]);
+    }
+
+    ContextModel model(tableOf, std::move(tables));
+    for (std::size_t c : active) {
+        const CodeTable& table = model.tables_[tableOf[c]];
+        for (std::size_t s = 0; s < 256; ++s) {
+            model.encodedBits_ += contexts[c][s] * table.lengths()[s];
+        }
+    }
+    return model;
+}
+
+void ContextModel::encodeTo(BitWriter& writer, std::string_view data) const {
+    unsigned char prev = 0;
+    for (char ch : data) {
+        const auto cur = static_cast<unsigned char>(ch);
+        tables_[tableOf_[prev]].writeSymbol(writer, cur);
+        prev = cur;
+    }
+}
+
+ContextDecoder::ContextDecoder(const ContextModel& model) : tableOf_(model.tableOf()) {
+    decoders_.reserve(model.tables().size());
+    for (const auto& table : model.tables()) {
+        // The next table depends on each decoded byte, so entries hold one
+        // symbol. Unused tables get a placeholder that is never selected.
+        decoders_.emplace_back(table.empty() ? CodeTable(std::vector<std::uint8_t>(256, 8)) : table,
+                               TableDecoderOptions{11, 1});
+    }
+}
+
+void ContextDecoder::decodeInto(char* out, std::size_t symbolCount, std::string_view bytes,
+                                std::size_t bitCount) const {
+    if (bitCount > bytes.size() * 8) {
+        throw std::invalid_argument("Bit count exceeds input size");
+    }
+    BitReader reader(bytes, bitCount);
+    unsigned char prev = 0;
+    for (std::size_t i = 0; i < symbolCount; ++i) {
+        prev = static_cast<unsigned char>(decoders_[tableOf_[prev]].decodeSymbol(reader));
+        out[i] = static_cast<char>(prev);
+    }
+    if (reader.bitsRemaining() != 0) {
+        throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+    }
+}
+
+} // namespace huffman
@@ -0,0 +1,653 @@
+#include "file_pipeline.h"
+
+#include "parallel.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HUFFMAN_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace huffman {
+
+namespace {
+
+[[nodiscard]] std::string errnoMessage(int error) {
+    return std::strerror(error);
+}
+
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd) noexcept : fd_(fd) {}
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    ~FileDescriptor() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    [[nodiscard]] int get() const noexcept { return fd_; }
+
+private:
+    int fd_;
+};
+
+// Deletes a partly written output unless dismissed once it is complete.
+class RemoveOnFailure {
+public:
+    explicit RemoveOnFailure(std::string path) : path_(std::move(path)) {}
+    RemoveOnFailure(const RemoveOnFailure&) = delete;
+    RemoveOnFailure& operator=(const RemoveOnFailure&) = delete;
+    ~RemoveOnFailure() {
+        if (!path_.empty()) ::unlink(path_.c_str());
+    }
+
+    void dismiss() noexcept { path_.clear(); }
+
+private:
+    std::string path_;
+};
+
+// Completed read, write or encode; `result` is a byte count or -errno.
+struct Event {
+    std::uint64_t tag = 0;
+    std::int64_t result = 0;
+};
+
+template <typename T>
+class BlockingQueue {
+public:
+    void push(T value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_.push_back(std::move(value));
+        }
+        ready_.notify_one();
+    }
+
+    [[nodiscard]] T pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return !items_.empty(); });
+        T value = std::move(items_.front());
+        items_.pop_front();
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<T> items_;
+};
+
+using EventQueue = BlockingQueue<Event>;
+
+// Positional reads and writes whose completions arrive on an EventQueue.
+class AsyncFileIo {
+public:
+    virtual ~AsyncFileIo() = default;
+    virtual void read(int fd, char* buffer, std::size_t size, std::uint64_t offset,
+                      std::uint64_t tag) = 0;
+    virtual void write(int fd, const char* buffer, std::size_t size, std::uint64_t offset,
+                       std::uint64_t tag) = 0;
+};
+
+class ThreadFileIo final : public AsyncFileIo {
+public:
+    ThreadFileIo(EventQueue& events, std::size_t threads) : events_(events) {
+        for (std::size_t t = 0; t < threads; ++t) {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~ThreadFileIo() override {
+        for (std::size_t t = 0; t < threads_.size(); ++t) {
+            requests_.push(Request{});
+        }
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void read(int fd, char* buffer, std::size_t size, std::uint64_t offset,
+              std::uint64_t tag) override {
+        requests_.push(Request{fd, buffer, nullptr, size, offset, tag});
+    }
+
+    void write(int fd, const char* buffer, std::size_t size, std::uint64_t offset,
+               std::uint64_t tag) override {
+        requests_.push(Request{fd, nullptr, buffer, size, offset, tag});
+    }
+
+private:
+    struct Request {
+        int fd = -1;  // -1 stops a thread
+        char* readBuffer = nullptr;
+        const char* writeBuffer = nullptr;
+        std::size_t size = 0;
+        std::uint64_t offset = 0;
+        std::uint64_t tag = 0;
+    };
+
+    EventQueue& events_;
+    BlockingQueue<Request> requests_;
+    std::vector<std::thread> threads_;
+
+    void run() {
+        for (;;) {
+            const Request request = requests_.pop();
+            if (request.fd < 0) return;
+            const auto offset = static_cast<off_t>(request.offset);
+            const ssize_t n = request.readBuffer != nullptr
+                ? ::pread(request.fd, request.readBuffer, request.size, offset)
+                : ::pwrite(request.fd, request.writeBuffer, request.size, offset);
+            events_.push(Event{request.tag, n < 0 ? -static_cast<std::int64_t>(errno) : n});
+        }
+    }
+};
+
+#ifdef HUFFMAN_HAVE_IO_URING
+
+// Minimal io_uring over raw syscalls. The coordinating thread submits;
+// a reaper thread waits for completions and forwards them as events.
+class IoUringFileIo final : public AsyncFileIo {
+public:
+    // Returns nullptr if the kernel refuses to create a ring.
+    [[nodiscard]] static std::unique_ptr<IoUringFileIo> create(EventQueue& events,
+                                                               unsigned entries) {
+        std::unique_ptr<IoUringFileIo> io(new IoUringFileIo(events));
+        if (!io->setup(entries)) {
+            return nullptr;
+        }
+        io->reaper_ = std::thread([raw = io.get()] { raw->reap(); });
+        return io;
+    }
+
+    ~IoUringFileIo() override {
+        if (reaper_.joinable()) {
+            submit(IORING_OP_NOP, -1, 0, 0, 0, kStopTag);
+            reaper_.join();
+        }
+        if (sqes_ != nullptr) ::munmap(sqes_, sqesSize_);
+        if (cqRing_ != nullptr && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_ != nullptr) ::munmap(sqRing_, sqRingSize_);
+        if (ringFd_ >= 0) ::close(ringFd_);
+    }
+
+    void read(int fd, char* buffer, std::size_t size, std::uint64_t offset,
+              std::uint64_t tag) override {
+        submit(IORING_OP_READ, fd, reinterpret_cast<std::uintptr_t>(buffer), size, offset, tag);
+    }
+
+    void write(int fd, const char* buffer, std::size_t size, std::uint64_t offset,
+               std::uint64_t tag) override {
+        submit(IORING_OP_WRITE, fd, reinterpret_cast<std::uintptr_t>(buffer), size, offset, tag);
+    }
+
+private:
+    static constexpr std::uint64_t kStopTag = ~std::uint64_t{0};
+
+    EventQueue& events_;
+    std::thread reaper_;
+    int ringFd_ = -1;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqRingSize_ = 0;
+    std::size_t cqRingSize_ = 0;
+    std::size_t sqesSize_ = 0;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqMask_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned* cqMask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    explicit IoUringFileIo(EventQueue& events) : events_(events) {}
+
+    static int enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(
+            ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    bool setup(unsigned entries) {
+        io_uring_params params{};
+        ringFd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd_ < 0) {
+            return false;
+        }
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+        void* sq = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ringFd_, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) {
+            return false;
+        }
+        sqRing_ = sq;
+        if (singleMap) {
+            cqRing_ = sqRing_;
+        } else {
+            void* cq = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) {
+                return false;
+            }
+            cqRing_ = cq;
+        }
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ringFd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sqBase = static_cast<char*>(sqRing_);
+        auto* cqBase = static_cast<char*>(cqRing_);
+        sqTail_ = reinterpret_cast<unsigned*>(sqBase + params.sq_off.tail);
+        sqMask_ = reinterpret_cast<unsigned*>(sqBase + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sqBase + params.sq_off.array);
+        cqHead_ = reinterpret_cast<unsigned*>(cqBase + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cqBase + params.cq_off.tail);
+        cqMask_ = reinterpret_cast<unsigned*>(cqBase + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cqBase + params.cq_off.cqes);
+        return true;
+    }
+
+    // Callers keep at most `entries` operations in flight, so a slot is
+    // always free; only the coordinating thread (and the destructor) submit.
+    void submit(std::uint8_t opcode, int fd, std::uintptr_t address, std::size_t size,
+                std::uint64_t offset, std::uint64_t tag) {
+        const unsigned tail = *sqTail_;
+        const unsigned index = tail & *sqMask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = address;
+        sqe.len = static_cast<std::uint32_t>(size);
+        sqe.off = offset;
+        sqe.user_data = tag;
+        // Page-cache hits would otherwise be copied inline on the submitting
+        // thread, serializing all I/O behind the coordinator
+        if (opcode != IORING_OP_NOP) sqe.flags = IOSQE_ASYNC;
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+        while (enter(ringFd_, 1, 0, 0) < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                throw std::runtime_error("io_uring submit failed: " + errnoMessage(errno));
+            }
+        }
+    }
+
+    void reap() {
+        for (;;) {
+            const unsigned head = *cqHead_;
+            if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                enter(ringFd_, 0, 1, IORING_ENTER_GETEVENTS);
+                continue;
+            }
+            const io_uring_cqe cqe = cqes_[head & *cqMask_];
+            __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+            if (cqe.user_data == kStopTag) return;
+            events_.push(Event{cqe.user_data, cqe.res});
+        }
+    }
+};
+
+#endif // HUFFMAN_HAVE_IO_URING
+
+// Encodes blocks on worker threads; each finished block becomes an event.
+class EncodePool {
+public:
+    using Job = std::function<std::int64_t()>;
+
+    EncodePool(EventQueue& events, unsigned threads) : events_(events) {
+        for (unsigned t = 0; t < threads; ++t) {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~EncodePool() {
+        for (std::size_t t = 0; t < threads_.size(); ++t) {
+            jobs_.push({0, nullptr});
+        }
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void post(std::uint64_t tag, Job job) { jobs_.push({tag, std::move(job)}); }
+
+private:
+    EventQueue& events_;
+    BlockingQueue<std::pair<std::uint64_t, Job>> jobs_;
+    std::vector<std::thread> threads_;
+
+    void run() {
+        for (;;) {
+            auto [tag, job] = jobs_.pop();
+            if (!job) return;
+            events_.push(Event{tag, job()});
+        }
+    }
+};
+
+// Waits out the remaining completions when the coordinator unwinds early.
+class PendingDrain {
+public:
+    PendingDrain(EventQueue& events, const std::size_t& pending) noexcept
+        : events_(events), pending_(pending) {}
+    PendingDrain(const PendingDrain&) = delete;
+    PendingDrain& operator=(const PendingDrain&) = delete;
+    ~PendingDrain() {
+        for (std::size_t left = pending_; left > 0; --left) {
+            static_cast<void>(events_.pop());
+        }
+    }
+
+private:
+    EventQueue& events_;
+    const std::size_t& pending_;
+};
+
+enum class Operation : std::uint64_t {
+    Read = 1,
+    Encode = 2,
+    Write = 3,
+    Stream = 4,  // header and index writes
+};
+
+[[nodiscard]] std::uint64_t makeTag(Operation op, std::size_t slot) noexcept {
+    return (static_cast<std::uint64_t>(op) << 32) | slot;
+}
+
+struct Slot {
+    std::unique_ptr<char[]> input;
+    std::size_t block = 0;
+    std::size_t rawSize = 0;
+    std::size_t readDone = 0;
+    std::size_t writeDone = 0;
+    std::string encoded;
+    std::string error;
+    std::uint64_t streamOffset = 0;
+    bool encodedReady = false;
+    // From the start of its read until its write has fully completed
+    bool busy = false;
+};
+
+} // namespace
+
+const char* backendName(IoBackend backend) noexcept {
+    switch (backend) {
+    case IoBackend::Auto:
+        return "auto";
+    case IoBackend::IoUring:
+        return "io_uring";
+    case IoBackend::Threads:
+        return "threads";
+    }
+    return "unknown";
+}
+
+bool isIoUringAvailable() noexcept {
+#ifdef HUFFMAN_HAVE_IO_URING
+    static const bool available = [] {
+        io_uring_params params{};
+        const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, 1, &params));
+        if (fd < 0) return false;
+        ::close(fd);
+        return true;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+FileCompressResult compressFile(const std::string& inputPath, const std::string& outputPath,
+                                const FileCompressOptions& options) {
+    const StreamEncoder encoder(options.stream);
+    if (options.queueDepth == 0 || options.queueDepth > 1024) {
+        throw std::invalid_argument("Queue depth must be between 1 and 1024");
+    }
+    IoBackend backend = options.backend;
+    if (backend == IoBackend::Auto) {
+        backend = isIoUringAvailable() ? IoBackend::IoUring : IoBackend::Threads;
+    }
+
+    const FileDescriptor input(::open(inputPath.c_str(), O_RDONLY | O_CLOEXEC));
+    if (input.get() < 0) {
+        throw std::runtime_error("Could not open file: " + inputPath + ": " + errnoMessage(errno));
+    }
+    struct stat info {};
+    if (::fstat(input.get(), &info) != 0) {
+        throw std::runtime_error("Could not stat file: " + inputPath + ": " + errnoMessage(errno));
+    }
+    const auto totalSize = static_cast<std::uint64_t>(info.st_size);
+    const FileDescriptor output(
+        ::open(outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (output.get() < 0) {
+        throw std::runtime_error("Could not create file: " + outputPath + ": " +
+                                 errnoMessage(errno));
+    }
+    // Declared before the I/O backend and workers, so it runs after they stop
+    RemoveOnFailure cleanup(outputPath);
+
+    const std::size_t blockSize = options.stream.blockSize;
+    const auto blockCount = static_cast<std::size_t>((totalSize + blockSize - 1) / blockSize);
+    const std::size_t depth = std::min(options.queueDepth, std::max<std::size_t>(blockCount, 1));
+
+    // Buffers that reads, encodes and writes use. They and the event queue
+    // are declared before the I/O backend and the workers so that they
+    // outlive them.
+    const auto bufferSize =
+        static_cast<std::size_t>(std::clamp<std::uint64_t>(totalSize, 1, blockSize));
+    std::vector<Slot> slots(depth);
+    for (Slot& slot : slots) {
+        slot.input = std::make_unique<char[]>(bufferSize);
+    }
+    std::string header;
+    encoder.appendHeader(header, totalSize);
+    EventQueue events;
+    std::unique_ptr<AsyncFileIo> io;
+#ifdef HUFFMAN_HAVE_IO_URING
+    if (backend == IoBackend::IoUring) {
+        // Each slot has at most one operation in flight, plus a stream write
+        unsigned entries = 2;
+        while (entries < depth + 2) entries <<= 1;
+        io = IoUringFileIo::create(events, entries);
+    }
+#endif
+    if (!io) {
+        if (backend == IoBackend::IoUring && options.backend == IoBackend::IoUring) {
+            throw std::runtime_error("io_uring is not available");
+        }
+        backend = IoBackend::Threads;
+        io = std::make_unique<ThreadFileIo>(events, std::min<std::size_t>(depth, 4));
+    }
+    EncodePool pool(events, resolveThreadCount(options.threads));
+
+    std::size_t pending = 0;
+    // If anything below throws, wait for every operation in flight before
+    // the backend stops: a kernel read may still land in a slot otherwise
+    const PendingDrain drain(events, pending);
+    std::string error;
+    auto fail = [&](std::string message) {
+        if (error.empty()) error = std::move(message);
+    };
+
+    auto startRead = [&](std::size_t block) {
+        Slot& slot = slots[block % depth];
+        slot.block = block;
+        const std::uint64_t offset = std::uint64_t{block} * blockSize;
+        slot.rawSize =
+            static_cast<std::size_t>(std::min<std::uint64_t>(blockSize, totalSize - offset));
+        slot.readDone = 0;
+        slot.encodedReady = false;
+        slot.busy = true;
+        io->read(input.get(), slot.input.get(), slot.rawSize, offset,
+                 makeTag(Operation::Read, block % depth));
+        ++pending;
+    };
+
+    std::uint64_t streamOffset = header.size();
+    std::size_t streamDone = 0;
+    io->write(output.get(), header.data(), header.size(), 0, makeTag(Operation::Stream, 0));
+    ++pending;
+
+    // Block b always uses slot b % depth, so it can only start once the
+    // write of block b - depth is done. Writes complete out of order (several
+    // I/O threads, IOSQE_ASYNC), so that is checked rather than assumed.
+    std::size_t nextRead = 0;
+    auto startReads = [&] {
+        while (nextRead < blockCount && !slots[nextRead % depth].busy) {
+            startRead(nextRead++);
+        }
+    };
+    startReads();
+
+    std::vector<BlockLocation> index;
+    std::size_t nextWrite = 0;
+    // Finished blocks are written strictly in order, which fixes their offsets
+    auto flushWrites = [&] {
+        while (error.empty() && nextWrite < blockCount) {
+            Slot& slot = slots[nextWrite % depth];
+            if (slot.block != nextWrite || !slot.encodedReady) return;
+            index.push_back({std::uint64_t{nextWrite} * blockSize, streamOffset});
+            slot.streamOffset = streamOffset;
+            slot.writeDone = 0;
+            streamOffset += slot.encoded.size();
+            io->write(output.get(), slot.encoded.data(), slot.encoded.size(), slot.streamOffset,
+                      makeTag(Operation::Write, nextWrite % depth));
+            ++pending;
+            ++nextWrite;
+        }
+    };
+
+    while (pending > 0) {
+        const Event event = events.pop();
+        --pending;
+        const auto op = static_cast<Operation>(event.tag >> 32);
+        const std::size_t s = static_cast<std::size_t>(event.tag & 0xFFFFFFFFu);
+        if (op != Operation::Encode && event.result < 0) {
+            fail(std::string(op == Operation::Read ? "Read failed: " : "Write failed: ") +
+                 errnoMessage(static_cast<int>(-event.result)));
+            continue;
+        }
+
+        switch (op) {
+        case Operation::Read: {
+            Slot& slot = slots[s];
+            if (event.result == 0) {
+                fail("Unexpected end of file: " + inputPath);
+                break;
+            }
+            slot.readDone += static_cast<std::size_t>(event.result);
+            if (!error.empty()) break;
+            if (slot.readDone < slot.rawSize) {
+                io->read(input.get(), slot.input.get() + slot.readDone,
+                         slot.rawSize - slot.readDone,
+                         std::uint64_t{slot.block} * blockSize + slot.readDone, event.tag);
+                ++pending;
+                break;
+            }
+            pool.post(makeTag(Operation::Encode, s), [&encoder, &slot]() -> std::int64_t {
+                slot.encoded.clear();
+                try {
+                    encoder.appendBlock(slot.encoded,
+                                        std::string_view(slot.input.get(), slot.rawSize));
+                } catch (const std::exception& e) {
+                    slot.error = e.what();
+                    return -1;
+                }
+                return 0;
+            });
+            ++pending;
+            break;
+        }
+        case Operation::Encode:
+            if (event.result < 0) {
+                fail("Encoding failed: " + slots[s].error);
+                break;
+            }
+            slots[s].encodedReady = true;
+            flushWrites();
+            break;
+        case Operation::Write: {
+            Slot& slot = slots[s];
+            slot.writeDone += static_cast<std::size_t>(event.result);
+            if (!error.empty()) break;
+            if (slot.writeDone < slot.encoded.size()) {
+                io->write(output.get(), slot.encoded.data() + slot.writeDone,
+                          slot.encoded.size() - slot.writeDone, slot.streamOffset + slot.writeDone,
+                          event.tag);
+                ++pending;
+                break;
+            }
+            slot.busy = false;
+            startReads();
+            break;
+        }
+        case Operation::Stream:
+            streamDone += static_cast<std::size_t>(event.result);
+            if (streamDone < header.size() && error.empty()) {
+                io->write(output.get(), header.data() + streamDone, header.size() - streamDone,
+                          streamDone, event.tag);
+                ++pending;
+            }
+            break;
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    if (options.stream.blockIndex) {
+        std::string trailer;
+        encoder.appendIndex(trailer, index, streamOffset);
+        for (std::size_t done = 0; done < trailer.size();) {
+            const ssize_t n = ::pwrite(output.get(), trailer.data() + done, trailer.size() - done,
+                                       static_cast<off_t>(streamOffset + done));
+            if (n < 0) {
+                throw std::runtime_error("Write failed: " + errnoMessage(errno));
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        streamOffset += trailer.size();
+    }
+
+    FileCompressResult result;
+    result.bytesIn = totalSize;
+    result.bytesOut = streamOffset;
+    result.backend = backend;
+    result.stats = encoder.stats();
+    cleanup.dismiss();
+    return result;
+}
+
+} // namespace huffman
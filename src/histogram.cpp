@@ -0,0 +1,257 @@
+#include "histogram.h"
+
+#include "code_table.h"
+#include "cpu_features.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef HUFFMAN_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace huffman {
+
+namespace {
+
+// Sub-histograms are 32-bit; inputs are counted in chunks small enough that
+// they cannot overflow before being folded into the 64-bit result.
+constexpr std::size_t kChunkSize = std::size_t{1} << 30;
+
+template <std::size_t N>
+using SubHistograms = std::array<std::array<std::uint32_t, 256>, N>;
+
+template <std::size_t N>
+void fold(const SubHistograms<N>& sub, Histogram& result) noexcept {
+    for (std::size_t b = 0; b < 256; ++b) {
+        std::uint64_t sum = 0;
+        for (std::size_t t = 0; t < N; ++t) {
+            sum += sub[t][b];
+        }
+        result[b] += sum;
+    }
+}
+
+// Spreads the eight bytes of `word` over two sub-histograms so consecutive
+// increments of the same byte do not serialize on one counter.
+inline void countWord(std::uint64_t word, std::uint32_t* a, std::uint32_t* b) noexcept {
+    ++a[word & 0xFF];
+    ++b[(word >> 8) & 0xFF];
+    ++a[(word >> 16) & 0xFF];
+    ++b[(word >> 24) & 0xFF];
+    ++a[(word >> 32) & 0xFF];
+    ++b[(word >> 40) & 0xFF];
+    ++a[(word >> 48) & 0xFF];
+    ++b[word >> 56];
+}
+
+void countScalar(const unsigned char* p, std::size_t n, Histogram& result) {
+    SubHistograms<4> sub{};
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        ++sub[0][p[i]];
+        ++sub[1][p[i + 1]];
+        ++sub[2][p[i + 2]];
+        ++sub[3][p[i + 3]];
+    }
+    for (; i < n; ++i) {
+        ++sub[0][p[i]];
+    }
+    fold(sub, result);
+}
+
+#ifdef HUFFMAN_X86_DISPATCH
+
+__attribute__((target("sse4.1")))
+void countSse4(const unsigned char* p, std::size_t n, Histogram& result) {
+    SubHistograms<4> sub{};
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // A run of one byte value is counted with a single add
+        const __m128i first = _mm_shuffle_epi8(v, zero);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, first)) == 0xFFFF) {
+            sub[0][p[i]] += 16;
+            continue;
+        }
+        countWord(static_cast<std::uint64_t>(_mm_cvtsi128_si64(v)), sub[0].data(), sub[1].data());
+        countWord(static_cast<std::uint64_t>(_mm_extract_epi64(v, 1)), sub[2].data(), sub[3].data());
+    }
+    for (; i < n; ++i) {
+        ++sub[0][p[i]];
+    }
+    fold(sub, result);
+}
+
+__attribute__((target("avx2")))
+void countAvx2(const unsigned char* p, std::size_t n, Histogram& result) {
+    SubHistograms<8> sub{};
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i first = _mm256_broadcastb_epi8(_mm256_castsi256_si128(v));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, first)) == -1) {
+            sub[0][p[i]] += 32;
+            continue;
+        }
+        countWord(static_cast<std::uint64_t>(_mm256_extract_epi64(v, 0)), sub[0].data(), sub[1].data());
+        countWord(static_cast<std::uint64_t>(_mm256_extract_epi64(v, 1)), sub[2].data(), sub[3].data());
+        countWord(static_cast<std::uint64_t>(_mm256_extract_epi64(v, 2)), sub[4].data(), sub[5].data());
+        countWord(static_cast<std::uint64_t>(_mm256_extract_epi64(v, 3)), sub[6].data(), sub[7].data());
+    }
+    for (; i < n; ++i) {
+        ++sub[0][p[i]];
+    }
+    fold(sub, result);
+}
+
+#endif // HUFFMAN_X86_DISPATCH
+
+} // namespace
+
+bool isKernelSupported(HistogramKernel kernel) noexcept {
+    switch (kernel) {
+    case HistogramKernel::Scalar:
+        return true;
+    case HistogramKernel::Sse4:
+        return cpuHasSse41();
+    case HistogramKernel::Avx2:
+        return cpuHasAvx2();
+    }
+    return false;
+}
+
+HistogramKernel detectHistogramKernel() noexcept {
+    static const HistogramKernel best = [] {
+        if (isKernelSupported(HistogramKernel::Avx2)) return HistogramKernel::Avx2;
+        if (isKernelSupported(HistogramKernel::Sse4)) return HistogramKernel::Sse4;
+        return HistogramKernel::Scalar;
+    }();
+    return best;
+}
+
+const char* kernelName(HistogramKernel kernel) noexcept {
+    switch (kernel) {
+    case HistogramKernel::Scalar: return "scalar";
+    case HistogramKernel::Sse4: return "sse4";
+    case HistogramKernel::Avx2: return "avx2";
+    }
+    return "unknown";
+}
+
+Histogram computeHistogram(std::string_view data) {
+    return computeHistogram(data, detectHistogramKernel());
+}
+
+Histogram computeHistogram(std::string_view data, HistogramKernel kernel) {
+    if (!isKernelSupported(kernel)) {
+        throw std::invalid_argument(
+            std::string("Histogram kernel not supported on this CPU: ") + kernelName(kernel));
+    }
+
+    using CountFn = void (*)(const unsigned char*, std::size_t, Histogram&);
+    CountFn count = countScalar;
+#ifdef HUFFMAN_X86_DISPATCH
+    if (kernel == HistogramKernel::Avx2) {
+        count = countAvx2;
+    } else if (kernel == HistogramKernel::Sse4) {
+        count = countSse4;
+    }
+#endif
+
+    Histogram result{};
+    const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+    for (std::size_t offset = 0; offset < data.size(); offset += kChunkSize) {
+        count(p + offset, std::min(kChunkSize, data.size() - offset), result);
+    }
+    return result;
+}
+
+Histogram computeHistogramParallel(std::string_view data, unsigned threads) {
+    threads = resolveThreadCount(threads);
+    const std::size_t maxWorkers = std::max<std::size_t>(1, data.size() / kParallelHistogramMinSlice);
+    const auto workers = static_cast<unsigned>(std::min<std::size_t>(threads, maxWorkers));
+    if (workers <= 1) {
+        return computeHistogram(data);
+    }
+
+    // One table per worker, each on its own cache lines
+    struct alignas(64) Partial {
+        Histogram counts{};
+    };
+    std::vector<Partial> partials(workers);
+
+    const std::size_t slice = data.size() / workers;
+    parallelFor(workers, workers, [&](std::size_t w) {
+        const std::size_t begin = w * slice;
+        const std::size_t len = (w + 1 == workers) ? data.size() - begin : slice;
+        partials[w].counts = computeHistogram(data.substr(begin, len));
+    });
+
+    Histogram result = partials[0].counts;
+    for (unsigned w = 1; w < workers; ++w) {
+        for (std::size_t b = 0; b < result.size(); ++b) {
+            result[b] += partials[w].counts[b];
+        }
+    }
+    return result;
+}
+
+double entropyBitsPerByte(const Histogram& histogram) noexcept {
+    std::uint64_t total = 0;
+    for (auto n : histogram) total += n;
+    if (total == 0) return 0.0;
+    double bits = 0.0;
+    for (auto n : histogram) {
+        if (n == 0) continue;
+        const double p = static_cast<double>(n) / static_cast<double>(total);
+        bits -= p * std::log2(p);
+    }
+    return bits;
+}
+
+std::uint64_t estimateCompressedSize(const Histogram& histogram) {
+    const std::vector<std::uint64_t> counts(histogram.begin(), histogram.end());
+    const std::vector<std::uint8_t> lengths = buildCodeLengths(counts, CodeTable::kMaxCodeLength);
+    std::uint64_t bits = 0;
+    for (std::size_t b = 0; b < counts.size(); ++b) {
+        bits += counts[b] * lengths[b];
+    }
+    return 256 + (bits + 7) / 8;
+}
+
+Histogram sampleHistogram(std::string_view data, std::size_t sampleBytes) {
+    constexpr std::size_t kChunk = 4096;
+    const std::size_t chunks = std::max<std::size_t>(1, sampleBytes / kChunk);
+    if (data.size() <= chunks * kChunk) {
+        return computeHistogram(data);
+    }
+    // Chunks spread evenly so that local runs do not dominate the sample
+    const std::size_t stride = (data.size() - kChunk) / std::max<std::size_t>(1, chunks - 1);
+    Histogram result{};
+    for (std::size_t c = 0; c < chunks; ++c) {
+        const Histogram part = computeHistogram(data.substr(c * stride, kChunk));
+        for (std::size_t b = 0; b < result.size(); ++b) result[b] += part[b];
+    }
+    return result;
+}
+
+std::uint64_t estimateCompressedSize(std::string_view data, std::size_t sampleBytes) {
+    const Histogram sample = sampleHistogram(data, sampleBytes);
+    std::uint64_t sampled = 0;
+    for (auto n : sample) sampled += n;
+    if (sampled == data.size()) {
+        return estimateCompressedSize(sample);
+    }
+    const std::uint64_t payload = estimateCompressedSize(sample) - 256;
+    const double scale = static_cast<double>(data.size()) / static_cast<double>(sampled);
+    return 256 + static_cast<std::uint64_t>(std::llround(static_cast<double>(payload) * scale));
+}
+
+} // namespace huffman
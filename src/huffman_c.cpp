@@ -0,0 +1,231 @@
+#include "huffman_c.h"
+
+#include "stream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+struct huff_context {
+    huffman::StreamEncoder encoder;
+    huffman::StreamDecoder decoder;
+    // Output of huff_compress calls below the bound is staged here and
+    // reused across calls
+    std::string scratch;
+    std::string lastError;
+};
+
+namespace {
+
+// huff_options as first released. Fields are only ever appended, so a caller
+// struct at least this large holds all of them.
+constexpr std::size_t kFirstOptionsSize = offsetof(huff_options, bwt) + sizeof(int);
+
+[[nodiscard]] huffman::StreamOptions toStreamOptions(const huff_options& options) {
+    huffman::StreamOptions stream;
+    stream.blockSize = options.block_size;
+    stream.syncInterval = options.sync_interval;
+    stream.blockIndex = options.block_index != 0;
+    stream.contextTables = options.context_tables;
+    stream.lz77Level = options.lz77_level;
+    stream.runLength = options.run_length != 0;
+    stream.bwt = options.bwt != 0;
+    return stream;
+}
+
+// Runs `fn`, translating library exceptions into status codes
+template <typename Fn>
+huff_status guarded(huff_context* context, Fn&& fn) noexcept {
+    try {
+        context->lastError.clear();
+        return fn();
+    } catch (const std::bad_alloc&) {
+        return HUFF_ERROR_OUT_OF_MEMORY;
+    } catch (const std::invalid_argument& e) {
+        context->lastError = e.what();
+        return HUFF_ERROR_INVALID_ARGUMENT;
+    } catch (const std::runtime_error& e) {
+        context->lastError = e.what();
+        return HUFF_ERROR_CORRUPT_INPUT;
+    } catch (const std::exception& e) {
+        context->lastError = e.what();
+        return HUFF_ERROR_INTERNAL;
+    } catch (...) {
+        return HUFF_ERROR_INTERNAL;
+    }
+}
+
+[[nodiscard]] std::string_view bytesOf(const void* data, std::size_t size) noexcept {
+    return {static_cast<const char*>(data), size};
+}
+
+} // namespace
+
+extern "C" {
+
+void huff_options_init(huff_options* options) {
+    if (options == nullptr) return;
+    const huffman::StreamOptions defaults;
+    *options = huff_options{};
+    options->struct_size = sizeof(huff_options);
+    options->block_size = defaults.blockSize;
+    options->sync_interval = defaults.syncInterval;
+    options->threads = 1;
+    options->context_tables = defaults.contextTables;
+    options->lz77_level = defaults.lz77Level;
+    options->block_index = defaults.blockIndex ? 1 : 0;
+    options->run_length = defaults.runLength ? 1 : 0;
+    options->bwt = defaults.bwt ? 1 : 0;
+}
+
+huff_context* huff_context_create(const huff_options* options) {
+    huff_options resolved;
+    huff_options_init(&resolved);
+    if (options != nullptr) {
+        if (options->struct_size < kFirstOptionsSize) {
+            return nullptr;
+        }
+        // Fields an older caller does not know keep their defaults, and
+        // fields from a newer header are ignored
+        std::memcpy(&resolved, options, std::min(options->struct_size, sizeof(huff_options)));
+        resolved.struct_size = sizeof(huff_options);
+    }
+    try {
+        return new huff_context{huffman::StreamEncoder(toStreamOptions(resolved)),
+                                huffman::StreamDecoder(resolved.threads), {}, {}};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void huff_context_free(huff_context* context) {
+    delete context;
+}
+
+size_t huff_compress_bound(const huff_context* context, size_t src_size) {
+    return context != nullptr ? context->encoder.maxEncodedSize(src_size) : 0;
+}
+
+huff_status huff_compress(huff_context* context, const void* src, size_t src_size, void* dst,
+                          size_t dst_capacity, size_t* dst_size) {
+    if (context == nullptr || dst_size == nullptr || (src == nullptr && src_size != 0) ||
+        (dst == nullptr && dst_capacity != 0)) {
+        return HUFF_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded(context, [&] {
+        // With room for the worst case the stream goes straight into `dst`;
+        // otherwise it is staged so the required size can be reported
+        if (dst_capacity >= context->encoder.maxEncodedSize(src_size)) {
+            *dst_size = context->encoder.encodeInto(bytesOf(src, src_size),
+                                                    static_cast<char*>(dst), dst_capacity);
+            return HUFF_OK;
+        }
+        context->scratch.clear();
+        context->encoder.encodeTo(context->scratch, bytesOf(src, src_size));
+        *dst_size = context->scratch.size();
+        if (context->scratch.size() > dst_capacity) {
+            return HUFF_ERROR_DST_TOO_SMALL;
+        }
+        if (!context->scratch.empty()) {
+            std::memcpy(dst, context->scratch.data(), context->scratch.size());
+        }
+        return HUFF_OK;
+    });
+}
+
+huff_status huff_decompressed_size(const void* src, size_t src_size, uint64_t* size) {
+    if ((src == nullptr && src_size != 0) || size == nullptr) {
+        return HUFF_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        *size = huffman::StreamDecoder::decodedSize(bytesOf(src, src_size));
+        return HUFF_OK;
+    } catch (...) {
+        return HUFF_ERROR_CORRUPT_INPUT;
+    }
+}
+
+huff_status huff_decompress(huff_context* context, const void* src, size_t src_size, void* dst,
+                            size_t dst_capacity, size_t* dst_size) {
+    if (context == nullptr || dst_size == nullptr || (src == nullptr && src_size != 0) ||
+        (dst == nullptr && dst_capacity != 0)) {
+        return HUFF_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded(context, [&] {
+        const std::string_view stream = bytesOf(src, src_size);
+        const std::uint64_t size = huffman::StreamDecoder::decodedSize(stream);
+        if (size > dst_capacity) {
+            *dst_size = static_cast<std::size_t>(size);
+            return HUFF_ERROR_DST_TOO_SMALL;
+        }
+        *dst_size = context->decoder.decodeInto(stream, static_cast<char*>(dst), dst_capacity);
+        return HUFF_OK;
+    });
+}
+
+int huff_stats_enabled(void) {
+    return huffman::kStatsEnabled ? 1 : 0;
+}
+
+huff_status huff_get_stats(const huff_context* context, huff_stats_kind kind,
+                           huff_stats* stats) {
+    if (context == nullptr || stats == nullptr || stats->struct_size < sizeof(stats->struct_size) ||
+        (kind != HUFF_STATS_COMPRESS && kind != HUFF_STATS_DECOMPRESS)) {
+        return HUFF_ERROR_INVALID_ARGUMENT;
+    }
+    const huffman::Stats source =
+        kind == HUFF_STATS_COMPRESS ? context->encoder.stats() : context->decoder.stats();
+    huff_stats full;
+    full.struct_size = stats->struct_size;
+    full.bytes_in = source.bytesIn;
+    full.bytes_out = source.bytesOut;
+    full.blocks = source.blocks;
+    full.tables_built = source.tablesBuilt;
+    full.tables_reused = source.tablesReused;
+    full.stored_blocks = source.storedBlocks;
+    full.histogram_ns = source.histogramNs;
+    full.build_ns = source.buildNs;
+    full.encode_ns = source.encodeNs;
+    full.decode_ns = source.decodeNs;
+    // Callers built against an older header get the counters they know of
+    std::memcpy(stats, &full, std::min(stats->struct_size, sizeof(huff_stats)));
+    return HUFF_OK;
+}
+
+void huff_reset_stats(huff_context* context) {
+    if (context == nullptr) return;
+    context->encoder.resetStats();
+    context->decoder.resetStats();
+}
+
+const char* huff_last_error(const huff_context* context) {
+    return context != nullptr ? context->lastError.c_str() : "";
+}
+
+const char* huff_status_string(huff_status status) {
+    switch (status) {
+    case HUFF_OK:
+        return "ok";
+    case HUFF_ERROR_INVALID_ARGUMENT:
+        return "invalid argument";
+    case HUFF_ERROR_DST_TOO_SMALL:
+        return "destination buffer too small";
+    case HUFF_ERROR_CORRUPT_INPUT:
+        return "corrupt input";
+    case HUFF_ERROR_OUT_OF_MEMORY:
+        return "out of memory";
+    case HUFF_ERROR_INTERNAL:
+        return "internal error";
+    }
+    return "unknown status";
+}
+
+const char* huff_version(void) {
+    return HUFFMAN_VERSION;
+}
+
+} // extern "C"
@@ -0,0 +1,273 @@
+#include "lz77.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+constexpr unsigned kMinWindowBits = 8;
+constexpr unsigned kMaxWindowBits = 24;
+constexpr unsigned kHashBits = 15;
+constexpr std::uint32_t kNoPosition = std::numeric_limits<std::uint32_t>::max();
+
+struct LevelParams {
+    unsigned maxChain;
+    unsigned niceLength;
+    bool lazy;
+};
+
+constexpr LevelParams kLevels[] = {
+    {4, 8, false},     {8, 16, false},    {16, 32, false},
+    {16, 32, true},    {32, 64, true},    {128, 128, true},
+    {256, 258, true},  {1024, 258, true}, {4096, 258, true},
+};
+
+// Lengths and distances are split into a bucket code and raw extra bits:
+// values 0-3 have their own codes, larger ones use their top two bits as
+// the code and the remaining bits as extra bits (the deflate scheme).
+struct Bucket {
+    unsigned code;
+    unsigned extraBits;
+    std::uint32_t base;
+};
+
+[[nodiscard]] Bucket bucketOf(std::uint32_t value) noexcept {
+    if (value < 4) {
+        return {value, 0, value};
+    }
+    unsigned top = 31;
+    while ((value >> top) == 0) --top;
+    const unsigned second = (value >> (top - 1)) & 1u;
+    return {2 * top + second, top - 1, (2u | second) << (top - 1)};
+}
+
+[[nodiscard]] Bucket bucketForCode(unsigned code) noexcept {
+    if (code < 4) {
+        return {code, 0, code};
+    }
+    const unsigned top = code / 2;
+    return {code, top - 1, (2u | (code & 1u)) << (top - 1)};
+}
+
+[[nodiscard]] inline std::uint32_t hash3(const unsigned char* p) noexcept {
+    const std::uint32_t v = p[0] | (std::uint32_t{p[1]} << 8) | (std::uint32_t{p[2]} << 16);
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+[[nodiscard]] std::vector<std::uint8_t> lengthsFor(const std::vector<std::uint64_t>& freq) {
+    return buildCodeLengths(freq, CodeTable::kMaxCodeLength);
+}
+
+[[nodiscard]] std::optional<TableDecoder> decoderFor(const CodeTable& table) {
+    if (table.empty()) return std::nullopt;
+    return TableDecoder(table, TableDecoderOptions{11, 1});
+}
+
+[[nodiscard]] std::uint32_t readValue(BitReader& reader, const TableDecoder& decoder) {
+    const Bucket bucket = bucketForCode(decoder.decodeSymbol(reader));
+    reader.refill();
+    if (reader.bitsRemaining() < bucket.extraBits) {
+        throw std::runtime_error("Invalid encoded data: unexpected end of stream");
+    }
+    const auto extra = static_cast<std::uint32_t>(reader.peek(bucket.extraBits));
+    reader.consume(bucket.extraBits);
+    return bucket.base + extra;
+}
+
+} // namespace
+
+std::vector<Lz77Token> parseLz77(std::string_view data, const Lz77Options& options) {
+    if (options.windowBits < kMinWindowBits || options.windowBits > kMaxWindowBits) {
+        throw std::invalid_argument("LZ77 window bits must be between 8 and 24");
+    }
+    if (options.level < 1 || options.level > 9) {
+        throw std::invalid_argument("LZ77 level must be between 1 and 9");
+    }
+    if (data.size() >= kNoPosition) {
+        throw std::invalid_argument("Input too large for LZ77 parsing");
+    }
+
+    const LevelParams params = kLevels[options.level - 1];
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    const auto size = static_cast<std::uint32_t>(data.size());
+    const std::uint32_t windowSize = std::uint32_t{1} << options.windowBits;
+    const std::uint32_t windowMask = windowSize - 1;
+
+    std::vector<std::uint32_t> head(std::size_t{1} << kHashBits, kNoPosition);
+    std::vector<std::uint32_t> prev(std::min<std::size_t>(windowSize, data.size() + 1), kNoPosition);
+    const std::uint32_t prevMask = static_cast<std::uint32_t>(prev.size()) == windowSize
+                                       ? windowMask
+                                       : std::numeric_limits<std::uint32_t>::max();
+
+    auto insert = [&](std::uint32_t pos) {
+        if (pos + kLz77MinMatch > size) return;
+        const std::uint32_t h = hash3(bytes + pos);
+        prev[pos & prevMask] = head[h];
+        head[h] = pos;
+    };
+
+    // Longest match for `pos` among earlier positions with the same hash;
+    // chains are strictly decreasing, so stop once they leave the window.
+    auto longestMatch = [&](std::uint32_t pos) -> Lz77Token {
+        Lz77Token best{0, 0};
+        if (pos + kLz77MinMatch > size) return best;
+        const std::uint32_t maxLength = std::min<std::uint32_t>(kLz77MaxMatch, size - pos);
+        const std::uint32_t lowest = pos > windowSize ? pos - windowSize : 0;
+        std::uint32_t candidate = head[hash3(bytes + pos)];
+        for (unsigned chain = params.maxChain; chain != 0 && candidate != kNoPosition &&
+                                               candidate >= lowest;
+             --chain) {
+            if (bytes[candidate + best.length] == bytes[pos + best.length]) {
+                std::uint32_t length = 0;
+                while (length < maxLength && bytes[candidate + length] == bytes[pos + length]) {
+                    ++length;
+                }
+                if (length > best.length) {
+                    best = {length, pos - candidate};
+                    if (length >= params.niceLength || length == maxLength) break;
+                }
+            }
+            candidate = prev[candidate & prevMask];
+        }
+        if (best.length < kLz77MinMatch) best = {0, 0};
+        return best;
+    };
+
+    std::vector<Lz77Token> tokens;
+    tokens.reserve(data.size() / 4 + 16);
+    std::uint32_t pos = 0;
+    while (pos < size) {
+        Lz77Token match = longestMatch(pos);
+        insert(pos);
+        // Lazy matching: defer to a longer match starting one byte later
+        while (params.lazy && match.length != 0 && match.length < params.niceLength) {
+            const Lz77Token next = longestMatch(pos + 1);
+            if (next.length <= match.length) break;
+            tokens.push_back({bytes[pos], 0});
+            ++pos;
+            insert(pos);
+            match = next;
+        }
+        if (match.length == 0) {
+            tokens.push_back({bytes[pos], 0});
+            ++pos;
+            continue;
+        }
+        tokens.push_back(match);
+        for (std::uint32_t p = pos + 1; p < pos + match.length; ++p) {
+            insert(p);
+        }
+        pos += match.length;
+    }
+    return tokens;
+}
+
+Lz77Model::Lz77Model(CodeTable literals, CodeTable lengths, CodeTable distances)
+    : literals_(std::move(literals)),
+      lengths_(std::move(lengths)),
+      distances_(std::move(distances)) {
+    if (literals_.alphabetSize() != kLiteralSymbols || lengths_.alphabetSize() != kLengthSymbols ||
+        distances_.alphabetSize() != kDistanceSymbols) {
+        throw std::invalid_argument("LZ77 table has the wrong alphabet size");
+    }
+}
+
+Lz77Model Lz77Model::build(const std::vector<Lz77Token>& tokens) {
+    std::vector<std::uint64_t> literalFreq(kLiteralSymbols, 0);
+    std::vector<std::uint64_t> lengthFreq(kLengthSymbols, 0);
+    std::vector<std::uint64_t> distanceFreq(kDistanceSymbols, 0);
+    std::uint64_t extraBits = 0;
+    for (const Lz77Token& token : tokens) {
+        if (token.distance == 0) {
+            ++literalFreq[token.length];
+            continue;
+        }
+        const Bucket length = bucketOf(token.length - kLz77MinMatch);
+        const Bucket distance = bucketOf(token.distance - 1);
+        ++literalFreq[kMatchSymbol];
+        ++lengthFreq[length.code];
+        ++distanceFreq[distance.code];
+        extraBits += length.extraBits + distance.extraBits;
+    }
+
+    Lz77Model model(CodeTable(lengthsFor(literalFreq)), CodeTable(lengthsFor(lengthFreq)),
+                    CodeTable(lengthsFor(distanceFreq)));
+    std::uint64_t bits = extraBits;
+    for (std::size_t s = 0; s < kLiteralSymbols; ++s) {
+        bits += literalFreq[s] * model.literals_.lengths()[s];
+    }
+    for (std::size_t s = 0; s < kLengthSymbols; ++s) {
+        bits += lengthFreq[s] * model.lengths_.lengths()[s];
+    }
+    for (std::size_t s = 0; s < kDistanceSymbols; ++s) {
+        bits += distanceFreq[s] * model.distances_.lengths()[s];
+    }
+    model.encodedBits_ = bits;
+    return model;
+}
+
+void Lz77Model::encodeTo(BitWriter& writer, const std::vector<Lz77Token>& tokens) const {
+    for (const Lz77Token& token : tokens) {
+        if (token.distance == 0) {
+            literals_.writeSymbol(writer, token.length);
+            continue;
+        }
+        const Bucket length = bucketOf(token.length - kLz77MinMatch);
+        const Bucket distance = bucketOf(token.distance - 1);
+        literals_.writeSymbol(writer, kMatchSymbol);
+        lengths_.writeSymbol(writer, length.code);
+        writer.write(token.length - kLz77MinMatch - length.base, length.extraBits);
+        distances_.writeSymbol(writer, distance.code);
+        writer.write(token.distance - 1 - distance.base, distance.extraBits);
+    }
+}
+
+Lz77Decoder::Lz77Decoder(const Lz77Model& model)
+    : literals_(decoderFor(model.literals())),
+      lengths_(decoderFor(model.lengths())),
+      distances_(decoderFor(model.distances())) {}
+
+void Lz77Decoder::decodeInto(char* out, std::size_t size, std::string_view bytes,
+                             std::size_t bitCount) const {
+    if (bitCount > bytes.size() * 8) {
+        throw std::invalid_argument("Bit count exceeds input size");
+    }
+    BitReader reader(bytes, bitCount);
+    std::size_t pos = 0;
+    while (pos < size) {
+        if (!literals_) {
+            throw std::runtime_error("Invalid encoded data: no literal table");
+        }
+        const std::uint32_t symbol = literals_->decodeSymbol(reader);
+        if (symbol != Lz77Model::kMatchSymbol) {
+            out[pos++] = static_cast<char>(symbol);
+            continue;
+        }
+        if (!lengths_ || !distances_) {
+            throw std::runtime_error("Invalid encoded data: match without length or distance table");
+        }
+        const std::size_t length = readValue(reader, *lengths_) + std::size_t{kLz77MinMatch};
+        const std::size_t distance = readValue(reader, *distances_) + std::size_t{1};
+        if (distance > pos || length > size - pos) {
+            throw std::runtime_error("Invalid encoded data: match out of range");
+        }
+        char* dst = out + pos;
+        const char* src = dst - distance;
+        if (distance >= length) {
+            std::memcpy(dst, src, length);
+        } else {
+            // Overlapping copy repeats the last `distance` bytes
+            for (std::size_t i = 0; i < length; ++i) dst[i] = src[i];
+        }
+        pos += length;
+    }
+    if (reader.bitsRemaining() != 0) {
+        throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+    }
+}
+
+} // namespace huffman
@@ -1,22 +1,45 @@
+#include "file_pipeline.h"
 #include "huffman.h"
+#include "parallel.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
 
 namespace {
 
+// Suffix of files written by `compress`
+constexpr const char* kCompressedExtension = ".huf";
+
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [options] <text>\n"
+              << "       " << programName << " compress [options] <file|dir>...\n"
               << "Options:\n"
               << "  -h, --help     Show this help message\n"
               << "  -f <file>      Read input from file\n"
+              << "Compress options:\n"
+              << "  -r             Compress files in directories recursively\n"
+              << "  -o <dir>       Write outputs under <dir> instead of next to the inputs\n"
+              << "  -j <n>         Files compressed concurrently (default: one per core)\n"
+              << "  --io <mode>    I/O backend: auto, io_uring or threads (default: auto)\n"
+              << "  -q             Only print the summary\n"
+              << "  --stats        Print library statistics as JSON (needs HUFFMAN_STATS)\n"
               << "Example:\n"
               << "  " << programName << " \"hello world\"\n"
-              << "  " << programName << " -f input.txt\n";
+              << "  " << programName << " -f input.txt\n"
+              << "  " << programName << " compress -r logs/\n";
 }
 
 [[nodiscard]] std::string readFile(const std::string& filename) {
@@ -49,6 +72,194 @@ void printCharacter(char ch) {
     }
 }
 
+
+struct CompressJob {
+    fs::path input;
+    fs::path output;
+    std::uintmax_t size = 0;
+};
+
+// Output path for `file`, found under `root` (a directory argument, or the
+// file itself for a plain argument)
+[[nodiscard]] fs::path outputPathFor(const fs::path& file, const fs::path& root,
+                                     const fs::path& outputDir) {
+    if (outputDir.empty()) {
+        return fs::path(file.string() + kCompressedExtension);
+    }
+    const fs::path relative = file == root ? file.filename() : file.lexically_relative(root);
+    return outputDir / fs::path(relative.string() + kCompressedExtension);
+}
+
+// Expands the positional arguments into one job per regular file
+[[nodiscard]] std::vector<CompressJob> collectJobs(const std::vector<std::string>& inputs,
+                                                   bool recursive, const fs::path& outputDir) {
+    std::vector<CompressJob> jobs;
+    for (const std::string& input : inputs) {
+        const fs::path root(input);
+        if (fs::is_directory(root)) {
+            if (!recursive) {
+                throw std::runtime_error(input + " is a directory (use -r)");
+            }
+            for (const auto& entry : fs::recursive_directory_iterator(
+                     root, fs::directory_options::skip_permission_denied)) {
+                // Skip earlier outputs so that reruns do not compress them again
+                if (!entry.is_regular_file() || entry.path().extension() == kCompressedExtension) {
+                    continue;
+                }
+                jobs.push_back({entry.path(), outputPathFor(entry.path(), root, outputDir),
+                                entry.file_size()});
+            }
+        } else if (fs::is_regular_file(root)) {
+            jobs.push_back({root, outputPathFor(root, root, outputDir), fs::file_size(root)});
+        } else {
+            throw std::runtime_error("Could not open file: " + input);
+        }
+    }
+
+    // A file named twice is compressed once; distinct files that would share
+    // an output are an error, as concurrent workers would overwrite each other
+    std::set<fs::path> seenInputs;
+    std::map<fs::path, fs::path> inputOfOutput;
+    std::vector<CompressJob> unique;
+    for (CompressJob& job : jobs) {
+        if (!seenInputs.insert(fs::weakly_canonical(job.input)).second) continue;
+        const auto [it, inserted] =
+            inputOfOutput.emplace(fs::weakly_canonical(job.output), job.input);
+        if (!inserted) {
+            throw std::runtime_error(it->second.string() + " and " + job.input.string() +
+                                     " would both be written to " + job.output.string());
+        }
+        unique.push_back(std::move(job));
+    }
+    jobs = std::move(unique);
+
+    // Largest first, so a big file picked up last does not leave the other
+    // workers idle at the end
+    std::sort(jobs.begin(), jobs.end(),
+              [](const CompressJob& a, const CompressJob& b) { return a.size > b.size; });
+    return jobs;
+}
+
+[[nodiscard]] double ratioPercent(std::uint64_t in, std::uint64_t out) {
+    return in == 0 ? 0.0 : static_cast<double>(out) / static_cast<double>(in) * 100.0;
+}
+
+int runCompress(int argc, char* argv[]) {
+    bool recursive = false;
+    bool quiet = false;
+    bool printStats = false;
+    unsigned jobsCount = 0;
+    fs::path outputDir;
+    huffman::FileCompressOptions options;
+    std::vector<std::string> inputs;
+
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-r") {
+            recursive = true;
+        } else if (arg == "-q") {
+            quiet = true;
+        } else if (arg == "--stats") {
+            printStats = true;
+        } else if (arg == "-o" && hasValue) {
+            outputDir = argv[++i];
+        } else if (arg == "-j" && hasValue) {
+            const std::string count(argv[++i]);
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos ||
+                count.size() > 6) {
+                std::cerr << "Error: -j expects a number of files\n";
+                return EXIT_FAILURE;
+            }
+            jobsCount = static_cast<unsigned>(std::stoul(count));
+        } else if (arg == "--io" && hasValue) {
+            const std::string mode(argv[++i]);
+            if (mode == "auto") {
+                options.backend = huffman::IoBackend::Auto;
+            } else if (mode == "io_uring") {
+                options.backend = huffman::IoBackend::IoUring;
+            } else if (mode == "threads") {
+                options.backend = huffman::IoBackend::Threads;
+            } else {
+                std::cerr << "Error: Unknown I/O backend: " << mode << '\n';
+                return EXIT_FAILURE;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Error: Unknown or incomplete option: " << arg << '\n';
+            return EXIT_FAILURE;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "Error: compress requires at least one file or directory\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<CompressJob> jobs;
+    try {
+        jobs = collectJobs(inputs, recursive, outputDir);
+        std::set<fs::path> directories;
+        for (const CompressJob& job : jobs) {
+            if (job.output.has_parent_path()) directories.insert(job.output.parent_path());
+        }
+        for (const fs::path& directory : directories) {
+            fs::create_directories(directory);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // Parallelism comes from running files side by side; each file is
+    // encoded on its worker's thread alone.
+    options.threads = 1;
+    options.queueDepth = 4;
+
+    std::mutex outputMutex;
+    std::uint64_t totalIn = 0;
+    std::uint64_t totalOut = 0;
+    std::size_t failures = 0;
+    huffman::Stats stats;
+    const auto start = std::chrono::steady_clock::now();
+    huffman::parallelFor(jobs.size(), jobsCount, [&](std::size_t i) {
+        const CompressJob& job = jobs[i];
+        try {
+            const huffman::FileCompressResult result =
+                huffman::compressFile(job.input.string(), job.output.string(), options);
+            std::lock_guard<std::mutex> lock(outputMutex);
+            totalIn += result.bytesIn;
+            totalOut += result.bytesOut;
+            stats += result.stats;
+            if (!quiet) {
+                std::cout << job.input.string() << " -> " << job.output.string() << "  "
+                          << result.bytesIn << " -> " << result.bytesOut << " bytes ("
+                          << std::fixed << std::setprecision(1)
+                          << ratioPercent(result.bytesIn, result.bytesOut) << "%)\n";
+            }
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            ++failures;
+            std::cerr << "Error: " << job.input.string() << ": " << e.what() << '\n';
+        }
+    });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double seconds = elapsed.count();
+    std::cout << std::fixed << std::setprecision(1) << "Compressed " << jobs.size() - failures
+              << " of " << jobs.size() << " files: " << totalIn << " -> " << totalOut
+              << " bytes (" << ratioPercent(totalIn, totalOut) << "%) in " << std::setprecision(3)
+              << seconds << " s, " << std::setprecision(1)
+              << (seconds > 0.0 ? static_cast<double>(totalIn) / seconds / 1e6 : 0.0)
+              << " MB/s\n";
+    if (printStats) {
+        std::cout << std::setprecision(6) << "{\"files\":" << jobs.size()
+                  << ",\"failed\":" << failures << ",\"seconds\":" << seconds
+                  << ",\"stats\":" << stats.toJson() << "}\n";
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
@@ -66,6 +277,10 @@ int main(int argc, char* argv[]) {
         return EXIT_SUCCESS;
     }
 
+    if (arg1 == "compress") {
+        return runCompress(argc - 2, argv + 2);
+    }
+
     if (arg1 == "-f") {
         if (argc < 3) {
             std::cerr << "Error: -f option requires a filename\n";
@@ -112,10 +327,11 @@ int main(int argc, char* argv[]) {
 
         std::cout << "Huffman Codes:\n";
         const auto& codes = tree.getCodes();
-        for (const auto& [ch, code] : codes) {
+        for (std::size_t b = 0; b < codes.size(); ++b) {
+            if (codes[b].length == 0) continue;
             std::cout << "  ";
-            printCharacter(ch);
-            std::cout << " -> " << code << '\n';
+            printCharacter(static_cast<char>(b));
+            std::cout << " -> " << codes[b].toString() << '\n';
         }
 
         std::cout << '\n';
@@ -0,0 +1,205 @@
+#include "multi_table.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+constexpr int kRefinePasses = 4;
+// Cost charged for a symbol a table has no code for while refining
+constexpr std::uint8_t kMissingCost = CodeTable::kMaxCodeLength + 1;
+
+[[nodiscard]] unsigned tableCountFor(std::size_t tokens) noexcept {
+    if (tokens < 200) return 2;
+    if (tokens < 600) return 3;
+    if (tokens < 1200) return 4;
+    if (tokens < 2400) return 5;
+    return 6;
+}
+
+} // namespace
+
+MultiTableModel::MultiTableModel(std::vector<CodeTable> tables) : tables_(std::move(tables)) {
+    if (tables_.empty() || tables_.size() > kMaxTables) {
+        throw std::invalid_argument("Multi-table model needs between 1 and 6 tables");
+    }
+    for (const auto& table : tables_) {
+        if (table.alphabetSize() != tables_[0].alphabetSize()) {
+            throw std::invalid_argument("Multi-table model tables must share an alphabet");
+        }
+    }
+}
+
+MultiTableModel MultiTableModel::build(const std::vector<std::uint16_t>& tokens,
+                                       std::size_t alphabetSize, unsigned maxTables) {
+    if (maxTables == 0 || maxTables > kMaxTables) {
+        throw std::invalid_argument("Multi-table model needs between 1 and 6 tables");
+    }
+    std::vector<std::uint64_t> total(alphabetSize, 0);
+    for (auto token : tokens) {
+        if (token >= alphabetSize) {
+            throw std::invalid_argument("Token outside the alphabet");
+        }
+        ++total[token];
+    }
+    const std::size_t groups = (tokens.size() + kGroupSize - 1) / kGroupSize;
+    const auto tableCount = static_cast<std::size_t>(
+        std::max<std::size_t>(1, std::min<std::size_t>({maxTables, tableCountFor(tokens.size()), groups})));
+
+    // Initial tables each favour a contiguous symbol range holding an equal
+    // share of the tokens
+    std::vector<std::vector<std::uint8_t>> costs(tableCount,
+                                                 std::vector<std::uint8_t>(alphabetSize, kMissingCost));
+    std::uint64_t remaining = tokens.size();
+    std::size_t symbol = 0;
+    for (std::size_t t = 0; t < tableCount; ++t) {
+        const std::uint64_t share = remaining / (tableCount - t);
+        std::uint64_t taken = 0;
+        while (symbol < alphabetSize && (taken < share || t + 1 == tableCount)) {
+            costs[t][symbol] = 0;
+            taken += total[symbol++];
+        }
+        remaining -= taken;
+    }
+
+    std::vector<std::uint8_t> selectors(groups, 0);
+    std::vector<std::vector<std::uint64_t>> freq;
+    std::vector<std::vector<std::uint8_t>> lengths(tableCount);
+    for (int pass = 0; pass < kRefinePasses; ++pass) {
+        freq.assign(tableCount, std::vector<std::uint64_t>(alphabetSize, 0));
+        for (std::size_t g = 0; g < groups; ++g) {
+            const std::size_t begin = g * kGroupSize;
+            const std::size_t end = std::min(tokens.size(), begin + kGroupSize);
+            std::size_t best = 0;
+            std::uint64_t bestCost = std::numeric_limits<std::uint64_t>::max();
+            for (std::size_t t = 0; t < tableCount; ++t) {
+                std::uint64_t cost = 0;
+                for (std::size_t i = begin; i < end; ++i) cost += costs[t][tokens[i]];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    best = t;
+                }
+            }
+            selectors[g] = static_cast<std::uint8_t>(best);
+            for (std::size_t i = begin; i < end; ++i) ++freq[best][tokens[i]];
+        }
+        for (std::size_t t = 0; t < tableCount; ++t) {
+            lengths[t] = buildCodeLengths(freq[t], CodeTable::kMaxCodeLength);
+            for (std::size_t s = 0; s < alphabetSize; ++s) {
+                costs[t][s] = lengths[t][s] != 0 ? lengths[t][s] : kMissingCost;
+            }
+        }
+    }
+
+    // Drop tables no group selected and renumber the selectors
+    std::vector<std::uint8_t> renumber(tableCount, 0);
+    std::vector<CodeTable> tables;
+    for (std::size_t t = 0; t < tableCount; ++t) {
+        const bool used = std::any_of(freq[t].begin(), freq[t].end(), [](auto n) { return n != 0; });
+        if (!used && !(t == 0 && tokens.empty())) continue;
+        renumber[t] = static_cast<std::uint8_t>(tables.size());
+        tables.emplace_back(std::move(lengths[t]));
+    }
+    for (auto& selector : selectors) selector = renumber[selector];
+
+    MultiTableModel model(std::move(tables));
+    model.selectors_ = std::move(selectors);
+    std::vector<std::uint8_t> order(model.tables_.size());
+    std::iota(order.begin(), order.end(), static_cast<std::uint8_t>(0));
+    for (std::size_t g = 0; g < groups; ++g) {
+        const std::uint8_t selector = model.selectors_[g];
+        const auto position = static_cast<std::size_t>(
+            std::find(order.begin(), order.end(), selector) - order.begin());
+        std::rotate(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(position),
+                    order.begin() + static_cast<std::ptrdiff_t>(position) + 1);
+        model.encodedBits_ += position + 1;
+        const std::size_t begin = g * kGroupSize;
+        const std::size_t end = std::min(tokens.size(), begin + kGroupSize);
+        for (std::size_t i = begin; i < end; ++i) {
+            model.encodedBits_ += model.tables_[selector].lengths()[tokens[i]];
+        }
+    }
+    return model;
+}
+
+void MultiTableModel::encodeTo(BitWriter& writer, const std::vector<std::uint16_t>& tokens) const {
+    const std::size_t groups = (tokens.size() + kGroupSize - 1) / kGroupSize;
+    if (groups != selectors_.size()) {
+        throw std::invalid_argument("Tokens do not match the model's selectors");
+    }
+    std::vector<std::uint8_t> order(tables_.size());
+    std::iota(order.begin(), order.end(), static_cast<std::uint8_t>(0));
+    for (auto selector : selectors_) {
+        const auto position = static_cast<unsigned>(
+            std::find(order.begin(), order.end(), selector) - order.begin());
+        std::rotate(order.begin(), order.begin() + position, order.begin() + position + 1);
+        // Unary: `position` ones then a zero
+        writer.write((1u << position) - 1, position + 1);
+    }
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        tables_[selectors_[i / kGroupSize]].writeSymbol(writer, tokens[i]);
+    }
+}
+
+MultiTableDecoder::MultiTableDecoder(const MultiTableModel& model) {
+    for (const auto& table : model.tables()) {
+        if (table.empty()) {
+            decoders_.emplace_back();
+        } else {
+            decoders_.emplace_back(std::in_place, table, TableDecoderOptions{11, 1});
+        }
+    }
+}
+
+std::vector<std::uint16_t> MultiTableDecoder::decode(std::string_view bytes, std::size_t bitCount,
+                                                     std::size_t tokenCount) const {
+    if (bitCount > bytes.size() * 8) {
+        throw std::invalid_argument("Bit count exceeds input size");
+    }
+    BitReader reader(bytes, bitCount);
+    const std::size_t groups = (tokenCount + MultiTableModel::kGroupSize - 1) / MultiTableModel::kGroupSize;
+    if (groups > bitCount) {
+        throw std::runtime_error("Invalid encoded data: unexpected end of stream");
+    }
+
+    std::vector<std::uint8_t> order(decoders_.size());
+    std::iota(order.begin(), order.end(), static_cast<std::uint8_t>(0));
+    std::vector<std::uint8_t> selectors(groups);
+    for (auto& selector : selectors) {
+        std::size_t position = 0;
+        for (;;) {
+            reader.refill();
+            if (reader.bitsRemaining() == 0) {
+                throw std::runtime_error("Invalid encoded data: unexpected end of stream");
+            }
+            const bool one = reader.peek(1) != 0;
+            reader.consume(1);
+            if (!one) break;
+            if (++position == order.size()) {
+                throw std::runtime_error("Invalid encoded data: bad table selector");
+            }
+        }
+        selector = order[position];
+        std::rotate(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(position),
+                    order.begin() + static_cast<std::ptrdiff_t>(position) + 1);
+    }
+
+    std::vector<std::uint16_t> tokens(tokenCount);
+    for (std::size_t i = 0; i < tokenCount; ++i) {
+        const auto& decoder = decoders_[selectors[i / MultiTableModel::kGroupSize]];
+        if (!decoder) {
+            throw std::runtime_error("Invalid encoded data: empty code table selected");
+        }
+        tokens[i] = static_cast<std::uint16_t>(decoder->decodeSymbol(reader));
+    }
+    if (reader.bitsRemaining() != 0) {
+        throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+    }
+    return tokens;
+}
+
+} // namespace huffman
@@ -0,0 +1,166 @@
+#include "run_length.h"
+
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+namespace huffman {
+
+void appendRunTokens(std::vector<std::uint16_t>& tokens, std::size_t count) {
+    while (count != 0) {
+        if (count & 1u) {
+            tokens.push_back(kRunA);
+            count = (count - 1) / 2;
+        } else {
+            tokens.push_back(kRunB);
+            count = (count - 2) / 2;
+        }
+    }
+}
+
+std::vector<std::uint16_t> runLengthTokens(std::string_view data) {
+    std::vector<std::uint16_t> tokens;
+    tokens.reserve(data.size() / 2 + 16);
+    unsigned char prev = 0;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        std::size_t run = 0;
+        while (pos + run < data.size() && static_cast<unsigned char>(data[pos + run]) == prev) {
+            ++run;
+        }
+        if (run != 0) {
+            appendRunTokens(tokens, run);
+            pos += run;
+            continue;
+        }
+        prev = static_cast<unsigned char>(data[pos++]);
+        tokens.push_back(prev);
+    }
+    return tokens;
+}
+
+std::vector<std::uint16_t> zeroRunTokens(std::string_view data) {
+    std::vector<std::uint16_t> tokens;
+    tokens.reserve(data.size() / 2 + 16);
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        std::size_t run = 0;
+        while (pos + run < data.size() && data[pos + run] == '\0') ++run;
+        if (run != 0) {
+            appendRunTokens(tokens, run);
+            pos += run;
+            continue;
+        }
+        tokens.push_back(static_cast<unsigned char>(data[pos++]));
+    }
+    return tokens;
+}
+
+std::string expandZeroRuns(const std::vector<std::uint16_t>& tokens, std::size_t size) {
+    std::string out;
+    out.reserve(size);
+    std::size_t run = 0;
+    std::size_t weight = 1;
+    for (auto token : tokens) {
+        if (token == kRunA || token == kRunB) {
+            if (weight > size) {
+                throw std::runtime_error("Invalid encoded data: run past end of output");
+            }
+            run += token == kRunA ? weight : 2 * weight;
+            weight <<= 1;
+            continue;
+        }
+        if (token == 0 || token > 0xFF || run > size - out.size()) {
+            throw std::runtime_error("Invalid encoded data: bad zero-run token");
+        }
+        out.append(run, '\0');
+        run = 0;
+        weight = 1;
+        if (out.size() == size) {
+            throw std::runtime_error("Invalid encoded data: run past end of output");
+        }
+        out.push_back(static_cast<char>(token));
+    }
+    if (run > size - out.size()) {
+        throw std::runtime_error("Invalid encoded data: run past end of output");
+    }
+    out.append(run, '\0');
+    if (out.size() != size) {
+        throw std::runtime_error("Invalid encoded data: output size mismatch");
+    }
+    return out;
+}
+
+RunLengthModel::RunLengthModel(CodeTable table) : table_(std::move(table)) {
+    if (table_.alphabetSize() != kAlphabetSize) {
+        throw std::invalid_argument("Run-length table has the wrong alphabet size");
+    }
+}
+
+RunLengthModel RunLengthModel::build(const std::vector<std::uint16_t>& tokens) {
+    std::vector<std::uint64_t> freq(kAlphabetSize, 0);
+    for (auto token : tokens) {
+        ++freq[token];
+    }
+    RunLengthModel model(CodeTable::fromFrequencies(freq));
+    for (std::size_t s = 0; s < kAlphabetSize; ++s) {
+        model.encodedBits_ += freq[s] * model.table_.lengths()[s];
+    }
+    return model;
+}
+
+void RunLengthModel::encodeTo(BitWriter& writer, const std::vector<std::uint16_t>& tokens) const {
+    for (auto token : tokens) {
+        table_.writeSymbol(writer, token);
+    }
+}
+
+RunLengthDecoder::RunLengthDecoder(const RunLengthModel& model) {
+    if (!model.table().empty()) {
+        decoder_.emplace(model.table(), TableDecoderOptions{11, 1});
+    }
+}
+
+void RunLengthDecoder::decodeInto(char* out, std::size_t size, std::string_view bytes,
+                                  std::size_t bitCount) const {
+    if (bitCount > bytes.size() * 8) {
+        throw std::invalid_argument("Bit count exceeds input size");
+    }
+    if (size != 0 && !decoder_) {
+        throw std::runtime_error("Invalid encoded data: empty code table");
+    }
+    BitReader reader(bytes, bitCount);
+    char prev = 0;
+    std::size_t pos = 0;
+    std::size_t run = 0;
+    std::size_t weight = 1;
+    auto flushRun = [&] {
+        if (run > size - pos) {
+            throw std::runtime_error("Invalid encoded data: run past end of output");
+        }
+        std::memset(out + pos, prev, run);
+        pos += run;
+        run = 0;
+        weight = 1;
+    };
+    while (pos + run < size) {
+        const std::uint32_t symbol = decoder_->decodeSymbol(reader);
+        if (symbol == kRunA || symbol == kRunB) {
+            if (weight > size) {
+                throw std::runtime_error("Invalid encoded data: run past end of output");
+            }
+            run += symbol == kRunA ? weight : 2 * weight;
+            weight <<= 1;
+            continue;
+        }
+        flushRun();
+        prev = static_cast<char>(symbol);
+        out[pos++] = prev;
+    }
+    flushRun();
+    if (reader.bitsRemaining() != 0) {
+        throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+    }
+}
+
+} // namespace huffman
@@ -0,0 +1,148 @@
+#include "speculative_decoder.h"
+
+#include "bitstream.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace huffman {
+
+namespace {
+
+// Codeword boundaries recorded at the head of each speculative chunk
+constexpr std::size_t kRecordedBoundaries = 1024;
+constexpr std::size_t kDecodeBatch = std::size_t{1} << 16;
+
+struct Chunk {
+    std::size_t startBit = 0;
+    std::size_t stopBit = 0;
+    // Boundaries of the first kRecordedBoundaries symbols, startBit included
+    std::vector<std::size_t> boundaries;
+    std::string symbols;
+    std::size_t endBit = 0;
+    bool failed = false;
+};
+
+// Decodes from chunk.startBit until the first boundary at or past
+// chunk.stopBit. Invalid codes are expected when the start is misaligned, so
+// they only mark the chunk as failed.
+void decodeChunk(const TableDecoder& decoder, std::string_view bytes, std::size_t bitCount,
+                 Chunk& chunk, bool recordBoundaries, DecodeKernel kernel) {
+    BitReader reader(bytes, chunk.startBit, bitCount);
+    chunk.symbols.clear();
+    chunk.boundaries.clear();
+    // A chunk re-decoded from its true boundary starts over
+    chunk.failed = false;
+    try {
+        if (recordBoundaries) {
+            while (chunk.boundaries.size() < kRecordedBoundaries &&
+                   reader.position() < chunk.stopBit) {
+                chunk.boundaries.push_back(reader.position());
+                chunk.symbols.push_back(static_cast<char>(decoder.decodeSymbol(reader)));
+            }
+            chunk.boundaries.push_back(reader.position());
+        }
+        while (reader.position() < chunk.stopBit) {
+            const std::size_t size = chunk.symbols.size();
+            chunk.symbols.resize(size + kDecodeBatch);
+            const std::size_t written = decoder.decodeUntil(reader, chunk.symbols.data() + size,
+                                                            kDecodeBatch, chunk.stopBit, kernel);
+            chunk.symbols.resize(size + written);
+        }
+    } catch (const std::runtime_error&) {
+        chunk.failed = true;
+    }
+    chunk.endBit = reader.position();
+}
+
+} // namespace
+
+std::string decodeSpeculative(const TableDecoder& decoder, std::string_view bytes,
+                              std::size_t bitCount, std::size_t symbolCount,
+                              unsigned threads, DecodeKernel kernel) {
+    if (bitCount > bytes.size() * 8) {
+        throw std::invalid_argument("Bit count exceeds input size");
+    }
+
+    const std::size_t chunkCount = std::min<std::size_t>(
+        resolveThreadCount(threads), bitCount / kSpeculativeMinChunkBits);
+    if (chunkCount <= 1) {
+        std::string out(symbolCount, '\0');
+        decoder.decodeInto(out.data(), symbolCount, bytes, 0, bitCount, kernel);
+        return out;
+    }
+
+    std::vector<Chunk> chunks(chunkCount);
+    const std::size_t chunkBits = bitCount / chunkCount;
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        chunks[i].startBit = i * chunkBits;
+        chunks[i].stopBit = (i + 1 == chunkCount) ? bitCount : (i + 1) * chunkBits;
+    }
+
+    // Speculative pass: every chunk decodes independently
+    parallelFor(chunkCount, threads, [&](std::size_t i) {
+        decodeChunk(decoder, bytes, bitCount, chunks[i], i != 0, kernel);
+    });
+
+    // Stitch in order. `skip[i]` symbols at the head of chunk i are garbage
+    // and are replaced by `heads[i]`, decoded from the true boundary.
+    std::vector<std::size_t> skip(chunkCount, 0);
+    std::vector<std::string> heads(chunkCount);
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        if (chunks[i].failed) {
+            throw std::runtime_error("Invalid encoded data: no matching code");
+        }
+        if (i + 1 == chunkCount) break;
+
+        Chunk& next = chunks[i + 1];
+        std::size_t truePos = chunks[i].endBit;
+        BitReader reader(bytes, truePos, bitCount);
+        std::size_t j = 0;
+        bool synced = false;
+        while (truePos < next.stopBit) {
+            while (j < next.boundaries.size() && next.boundaries[j] < truePos) ++j;
+            if (j == next.boundaries.size()) break;
+            if (next.boundaries[j] == truePos) {
+                synced = true;
+                break;
+            }
+            heads[i + 1].push_back(static_cast<char>(decoder.decodeSymbol(reader)));
+            truePos = reader.position();
+        }
+
+        if (synced) {
+            // A failure after the sync point is a failure of the true stream
+            skip[i + 1] = j;
+        } else {
+            heads[i + 1].clear();
+            next.startBit = chunks[i].endBit;
+            decodeChunk(decoder, bytes, bitCount, next, false, kernel);
+        }
+    }
+
+    if (chunks.back().endBit != bitCount) {
+        throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+    }
+
+    std::vector<std::size_t> offsets(chunkCount + 1, 0);
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        offsets[i + 1] = offsets[i] + heads[i].size() + (chunks[i].symbols.size() - skip[i]);
+    }
+    if (offsets.back() != symbolCount) {
+        throw std::runtime_error("Invalid encoded data: symbol count mismatch");
+    }
+
+    std::string out(symbolCount, '\0');
+    parallelFor(chunkCount, threads, [&](std::size_t i) {
+        char* dst = out.data() + offsets[i];
+        std::memcpy(dst, heads[i].data(), heads[i].size());
+        std::memcpy(dst + heads[i].size(), chunks[i].symbols.data() + skip[i],
+                    chunks[i].symbols.size() - skip[i]);
+    });
+    return out;
+}
+
+} // namespace huffman
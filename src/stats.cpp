@@ -0,0 +1,74 @@
+#include "stats.h"
+
+#include <sstream>
+
+namespace huffman {
+
+Stats& Stats::operator+=(const Stats& other) noexcept {
+    bytesIn += other.bytesIn;
+    bytesOut += other.bytesOut;
+    blocks += other.blocks;
+    tablesBuilt += other.tablesBuilt;
+    tablesReused += other.tablesReused;
+    storedBlocks += other.storedBlocks;
+    histogramNs += other.histogramNs;
+    buildNs += other.buildNs;
+    encodeNs += other.encodeNs;
+    decodeNs += other.decodeNs;
+    return *this;
+}
+
+std::string Stats::toJson() const {
+    std::ostringstream json;
+    json << "{\"enabled\":" << (kStatsEnabled ? "true" : "false")
+         << ",\"bytes_in\":" << bytesIn
+         << ",\"bytes_out\":" << bytesOut
+         << ",\"blocks\":" << blocks
+         << ",\"tables_built\":" << tablesBuilt
+         << ",\"tables_reused\":" << tablesReused
+         << ",\"stored_blocks\":" << storedBlocks
+         << ",\"histogram_ns\":" << histogramNs
+         << ",\"build_ns\":" << buildNs
+         << ",\"encode_ns\":" << encodeNs
+         << ",\"decode_ns\":" << decodeNs << '}';
+    return json.str();
+}
+
+Stats StatsCounters::snapshot() const noexcept {
+    Stats stats;
+#if HUFFMAN_STATS
+    auto get = [this](Stat stat) {
+        return values_[static_cast<std::size_t>(stat)].load(std::memory_order_relaxed);
+    };
+    stats.bytesIn = get(Stat::BytesIn);
+    stats.bytesOut = get(Stat::BytesOut);
+    stats.blocks = get(Stat::Blocks);
+    stats.tablesBuilt = get(Stat::TablesBuilt);
+    stats.tablesReused = get(Stat::TablesReused);
+    stats.storedBlocks = get(Stat::StoredBlocks);
+    stats.histogramNs = get(Stat::HistogramNs);
+    stats.buildNs = get(Stat::BuildNs);
+    stats.encodeNs = get(Stat::EncodeNs);
+    stats.decodeNs = get(Stat::DecodeNs);
+#endif
+    return stats;
+}
+
+void StatsCounters::reset() noexcept {
+#if HUFFMAN_STATS
+    for (auto& value : values_) {
+        value.store(0, std::memory_order_relaxed);
+    }
+#endif
+}
+
+void StatsCounters::copyFrom([[maybe_unused]] const StatsCounters& other) noexcept {
+#if HUFFMAN_STATS
+    for (std::size_t i = 0; i < values_.size(); ++i) {
+        values_[i].store(other.values_[i].load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    }
+#endif
+}
+
+} // namespace huffman
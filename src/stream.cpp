@@ -0,0 +1,891 @@
+#include "stream.h"
+
+#include "bitstream.h"
+#include "byte_io.h"
+#include "code_table.h"
+#include "context_model.h"
+#include "histogram.h"
+#include "huffman.h"
+#include "lz77.h"
+#include "multi_table.h"
+#include "parallel.h"
+#include "run_length.h"
+#include "speculative_decoder.h"
+#include "transform.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace huffman {
+
+namespace {
+
+constexpr std::string_view kMagic = "HUFS";
+constexpr std::string_view kIndexMagic = "HUFX";
+// Version 2 added the flags byte; version 1 streams are still readable
+constexpr std::uint8_t kVersion = 2;
+constexpr std::uint8_t kFlagBlockIndex = 0x01;
+// u64 index offset, u32 block count, index magic
+constexpr std::size_t kIndexFooterSize = 8 + 4 + kIndexMagic.size();
+// Magic, version, flags, block size, total size, block count
+constexpr std::size_t kHeaderSize = kMagic.size() + 1 + 1 + 4 + 8 + 4;
+// Type, raw size, bit count, sync interval, sync count; tables excluded
+constexpr std::size_t kBlockHeaderSize = 1 + 4 + 8 + 4 + 4;
+
+struct StreamHeader {
+    std::uint8_t flags = 0;
+    std::uint64_t totalSize = 0;
+    std::uint32_t blockCount = 0;
+};
+
+struct ParsedBlock {
+    BlockType type = BlockType::Huffman;
+    std::size_t rawSize = 0;
+    std::size_t outputOffset = 0;
+    std::vector<std::uint8_t> lengths;
+    // Context blocks: table per previous byte
+    std::array<std::uint8_t, 256> tableOf{};
+    // Length sets of context, LZ77, run-length and BWT blocks
+    std::vector<std::vector<std::uint8_t>> tableLengths;
+    // BWT blocks: zero-run tokens in the payload
+    std::size_t tokenCount = 0;
+    std::uint64_t bitCount = 0;
+    std::size_t syncInterval = 0;
+    std::vector<std::uint64_t> syncOffsets;
+    std::string_view payload;
+};
+
+// A run of symbols that can be decoded independently of its neighbours
+struct Segment {
+    std::size_t block = 0;
+    std::size_t outputOffset = 0;
+    std::size_t symbolCount = 0;
+    std::uint64_t bitBegin = 0;
+    std::uint64_t bitEnd = 0;
+};
+
+[[nodiscard]] StreamHeader parseHeader(ByteReader& reader) {
+    if (reader.bytes(kMagic.size()) != kMagic) {
+        throw std::runtime_error("Invalid stream: bad magic");
+    }
+    StreamHeader header;
+    const std::uint8_t version = reader.u8();
+    if (version == 0 || version > kVersion) {
+        throw std::runtime_error("Invalid stream: unsupported version");
+    }
+    if (version >= 2) {
+        header.flags = reader.u8();
+    }
+    (void)reader.u32();  // Block size is informational for the decoder
+    header.totalSize = reader.u64();
+    header.blockCount = reader.u32();
+    return header;
+}
+
+// Reads the trailing block index; the stream must carry one.
+[[nodiscard]] std::vector<BlockLocation> parseIndex(std::string_view stream,
+                                                 const StreamHeader& header) {
+    if (stream.size() < kIndexFooterSize) {
+        throw std::runtime_error("Invalid stream: missing block index");
+    }
+    ByteReader footer(stream.substr(stream.size() - kIndexFooterSize));
+    const std::uint64_t indexOffset = footer.u64();
+    const std::uint32_t count = footer.u32();
+    if (footer.bytes(kIndexMagic.size()) != kIndexMagic || count != header.blockCount ||
+        indexOffset + std::uint64_t{16} * count + kIndexFooterSize != stream.size()) {
+        throw std::runtime_error("Invalid stream: bad block index");
+    }
+
+    ByteReader reader(stream.substr(static_cast<std::size_t>(indexOffset)));
+    std::vector<BlockLocation> index(count);
+    for (std::size_t i = 0; i < index.size(); ++i) {
+        index[i].rawOffset = reader.u64();
+        index[i].streamOffset = reader.u64();
+        if (index[i].streamOffset >= indexOffset ||
+            (i > 0 && index[i].rawOffset < index[i - 1].rawOffset)) {
+            throw std::runtime_error("Invalid stream: bad block index");
+        }
+    }
+    return index;
+}
+
+// Huffman and RepeatHuffman blocks share the single-table code path
+[[nodiscard]] bool usesOrder0Table(BlockType type) noexcept {
+    return type == BlockType::Huffman || type == BlockType::RepeatHuffman;
+}
+
+// Counter a coded block adds to: every type but Stored and RepeatHuffman
+// carries its own tables
+[[nodiscard]] Stat blockStat(BlockType type) noexcept {
+    if (type == BlockType::Stored) return Stat::StoredBlocks;
+    if (type == BlockType::RepeatHuffman) return Stat::TablesReused;
+    return Stat::TablesBuilt;
+}
+
+// Stages applied ahead of coding in BWT blocks
+[[nodiscard]] const TransformPipeline& bwtPipeline() {
+    static const TransformPipeline pipeline({TransformStage::Bwt, TransformStage::MoveToFront});
+    return pipeline;
+}
+
+[[nodiscard]] ParsedBlock parseBlock(ByteReader& reader) {
+    ParsedBlock block;
+    const std::uint8_t type = reader.u8();
+    block.rawSize = reader.u32();
+    if (type == static_cast<std::uint8_t>(BlockType::Huffman)) {
+        block.type = BlockType::Huffman;
+        const std::string_view lengths = reader.bytes(256);
+        block.lengths.assign(lengths.begin(), lengths.end());
+    } else if (type == static_cast<std::uint8_t>(BlockType::ContextHuffman)) {
+        block.type = BlockType::ContextHuffman;
+        const std::size_t tableCount = std::size_t{reader.u8()} + 1;
+        const std::string_view tableOf = reader.bytes(256);
+        std::copy(tableOf.begin(), tableOf.end(), block.tableOf.begin());
+        for (std::size_t t = 0; t < tableCount; ++t) {
+            const std::string_view lengths = reader.bytes(256);
+            block.tableLengths.emplace_back(lengths.begin(), lengths.end());
+        }
+    } else if (type == static_cast<std::uint8_t>(BlockType::Lz77Huffman)) {
+        block.type = BlockType::Lz77Huffman;
+        for (std::size_t size : {Lz77Model::kLiteralSymbols, Lz77Model::kLengthSymbols,
+                                 Lz77Model::kDistanceSymbols}) {
+            const std::string_view lengths = reader.bytes(size);
+            block.tableLengths.emplace_back(lengths.begin(), lengths.end());
+        }
+    } else if (type == static_cast<std::uint8_t>(BlockType::RunLengthHuffman)) {
+        block.type = BlockType::RunLengthHuffman;
+        const std::string_view lengths = reader.bytes(RunLengthModel::kAlphabetSize);
+        block.tableLengths.emplace_back(lengths.begin(), lengths.end());
+    } else if (type == static_cast<std::uint8_t>(BlockType::RepeatHuffman)) {
+        // Lengths come from the nearest earlier Huffman block
+        block.type = BlockType::RepeatHuffman;
+    } else if (type == static_cast<std::uint8_t>(BlockType::Stored)) {
+        block.type = BlockType::Stored;
+    } else if (type == static_cast<std::uint8_t>(BlockType::BwtHuffman)) {
+        block.type = BlockType::BwtHuffman;
+        block.tokenCount = reader.u32();
+        const std::size_t tableCount = reader.u8();
+        for (std::size_t t = 0; t < tableCount; ++t) {
+            const std::string_view lengths = reader.bytes(RunLengthModel::kAlphabetSize);
+            block.tableLengths.emplace_back(lengths.begin(), lengths.end());
+        }
+    } else {
+        throw std::runtime_error("Invalid stream: unknown block type");
+    }
+    block.bitCount = reader.u64();
+    if (block.type == BlockType::Stored && block.bitCount != std::uint64_t{block.rawSize} * 8) {
+        throw std::runtime_error("Invalid stream: stored block size mismatch");
+    }
+    block.syncInterval = reader.u32();
+
+    const std::uint32_t syncCount = reader.u32();
+    const std::size_t expected = (block.syncInterval == 0 || block.rawSize == 0)
+        ? 0 : (block.rawSize - 1) / block.syncInterval;
+    if (syncCount != expected || (!usesOrder0Table(block.type) && syncCount != 0)) {
+        throw std::runtime_error("Invalid stream: sync point count mismatch");
+    }
+    block.syncOffsets.reserve(syncCount);
+    for (std::uint32_t i = 0; i < syncCount; ++i) {
+        const std::uint64_t offset = reader.u64();
+        const std::uint64_t previous = block.syncOffsets.empty() ? 0 : block.syncOffsets.back();
+        if (offset < previous || offset > block.bitCount) {
+            throw std::runtime_error("Invalid stream: sync points out of order");
+        }
+        block.syncOffsets.push_back(offset);
+    }
+
+    if (block.bitCount > std::numeric_limits<std::size_t>::max() - 7) {
+        throw std::runtime_error("Invalid stream: block too large");
+    }
+    block.payload = reader.bytes(static_cast<std::size_t>((block.bitCount + 7) / 8));
+    return block;
+}
+
+// Decoding state for one block, built from its header
+struct BlockDecoder {
+    std::shared_ptr<const TableDecoder> table;
+    std::unique_ptr<ContextDecoder> context;
+    std::unique_ptr<Lz77Decoder> lz77;
+    std::unique_ptr<RunLengthDecoder> runLength;
+    std::unique_ptr<MultiTableDecoder> multiTable;
+
+    // Decodes a whole block whose symbols depend on earlier output, or
+    // copies a stored one
+    void decodeWhole(const ParsedBlock& block, char* out) const {
+        const auto bitCount = static_cast<std::size_t>(block.bitCount);
+        if (block.type == BlockType::Stored) {
+            std::memcpy(out, block.payload.data(), block.rawSize);
+        } else if (context) {
+            context->decodeInto(out, block.rawSize, block.payload, bitCount);
+        } else if (multiTable) {
+            // Zero-run tokens expand to the pipeline output: BWT index + bytes
+            const std::vector<std::uint16_t> tokens =
+                multiTable->decode(block.payload, bitCount, block.tokenCount);
+            const std::string bytes =
+                bwtPipeline().inverse(expandZeroRuns(tokens, block.rawSize + 4));
+            std::copy(bytes.begin(), bytes.end(), out);
+        } else if (lz77) {
+            lz77->decodeInto(out, block.rawSize, block.payload, bitCount);
+        } else {
+            runLength->decodeInto(out, block.rawSize, block.payload, bitCount);
+        }
+    }
+};
+
+[[nodiscard]] BlockDecoder makeBlockDecoder(const ParsedBlock& block) {
+    BlockDecoder decoder;
+    if (block.rawSize == 0) {
+        return decoder;
+    }
+    try {
+        if (block.type == BlockType::ContextHuffman) {
+            std::vector<CodeTable> tables;
+            for (const auto& lengths : block.tableLengths) {
+                tables.emplace_back(lengths);
+            }
+            decoder.context = std::make_unique<ContextDecoder>(
+                ContextModel(block.tableOf, std::move(tables)));
+        } else if (block.type == BlockType::Lz77Huffman) {
+            decoder.lz77 = std::make_unique<Lz77Decoder>(
+                Lz77Model(CodeTable(block.tableLengths[0]), CodeTable(block.tableLengths[1]),
+                          CodeTable(block.tableLengths[2])));
+        } else if (block.type == BlockType::BwtHuffman) {
+            std::vector<CodeTable> tables;
+            for (const auto& lengths : block.tableLengths) {
+                tables.emplace_back(lengths);
+            }
+            decoder.multiTable = std::make_unique<MultiTableDecoder>(MultiTableModel(std::move(tables)));
+        } else if (block.type == BlockType::RunLengthHuffman) {
+            decoder.runLength = std::make_unique<RunLengthDecoder>(
+                RunLengthModel(CodeTable(block.tableLengths[0])));
+        } else if (usesOrder0Table(block.type)) {
+            if (block.lengths.empty()) {
+                throw std::runtime_error("Invalid stream: repeated table without an earlier one");
+            }
+            decoder.table = std::make_shared<TableDecoder>(CodeTable(block.lengths));
+        }
+    } catch (const std::invalid_argument&) {
+        throw std::runtime_error("Invalid stream: bad code lengths");
+    }
+    return decoder;
+}
+
+} // namespace
+
+StreamEncoder::StreamEncoder(StreamOptions options) : options_(options) {
+    if (options_.blockSize == 0 || options_.blockSize > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Block size must be between 1 and 2^32 - 1 bytes");
+    }
+    if (options_.syncInterval > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Sync interval must fit in 32 bits");
+    }
+    if (options_.contextTables > ContextModel::kMaxTables) {
+        throw std::invalid_argument("Context table count must be at most 256");
+    }
+    if (options_.lz77Level > 9) {
+        throw std::invalid_argument("LZ77 level must be between 0 and 9");
+    }
+    if (options_.lz77Level > 0 && (options_.lz77WindowBits < 8 || options_.lz77WindowBits > 24)) {
+        throw std::invalid_argument("LZ77 window bits must be between 8 and 24");
+    }
+}
+
+std::string StreamEncoder::encode(std::string_view input) const {
+    std::string out;
+    out.reserve(input.size() / 2 + 64);
+    encodeTo(out, input);
+    return out;
+}
+
+std::size_t StreamEncoder::maxEncodedSize(std::size_t inputSize) const noexcept {
+    // Every block is at most a stored block plus one padding byte and its
+    // sync offsets: any model must beat raw storage to be chosen.
+    const std::size_t blockCount = (inputSize + options_.blockSize - 1) / options_.blockSize;
+    std::size_t syncOffsets = 0;
+    if (options_.syncInterval != 0) {
+        syncOffsets = inputSize / options_.syncInterval;
+    }
+    std::size_t size = kHeaderSize + inputSize + blockCount * (kBlockHeaderSize + 1) +
+                       syncOffsets * 8;
+    if (options_.blockIndex) {
+        size += blockCount * 16 + kIndexFooterSize;
+    }
+    return size;
+}
+
+void StreamEncoder::encodeTo(std::string& out, std::string_view input) const {
+    encodeStream(out, input);
+}
+
+std::size_t StreamEncoder::encodeInto(std::string_view input, char* out,
+                                      std::size_t capacity) const {
+    if (capacity < maxEncodedSize(input.size())) {
+        throw std::invalid_argument("Output buffer is smaller than maxEncodedSize");
+    }
+    SpanWriter writer(out, capacity);
+    encodeStream(writer, input);
+    return writer.size();
+}
+
+template <typename Out>
+void StreamEncoder::encodeStream(Out& out, std::string_view input) const {
+    const std::size_t streamStart = out.size();
+    writeHeader(out, input.size());
+
+    std::vector<BlockLocation> index;
+    index.reserve(options_.blockIndex ? input.size() / options_.blockSize + 1 : 0);
+    std::optional<CodeTable> previousTable;
+    for (std::size_t offset = 0; offset < input.size(); offset += options_.blockSize) {
+        if (options_.blockIndex) {
+            index.push_back({offset, out.size() - streamStart});
+        }
+        encodeBlock(out, input.substr(offset, options_.blockSize), previousTable,
+                    offset + options_.blockSize < input.size());
+    }
+
+    if (options_.blockIndex) {
+        writeIndex(out, index, out.size() - streamStart);
+    }
+}
+
+void StreamEncoder::appendHeader(std::string& out, std::uint64_t totalSize) const {
+    writeHeader(out, totalSize);
+}
+
+template <typename Out>
+void StreamEncoder::writeHeader(Out& out, std::uint64_t totalSize) const {
+    const std::uint64_t blockCount = (totalSize + options_.blockSize - 1) / options_.blockSize;
+    if (blockCount > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Input has too many blocks for the stream format");
+    }
+
+    out.append(kMagic);
+    appendU8(out, kVersion);
+    appendU8(out, options_.blockIndex ? kFlagBlockIndex : 0);
+    appendU32(out, static_cast<std::uint32_t>(options_.blockSize));
+    appendU64(out, totalSize);
+    appendU32(out, static_cast<std::uint32_t>(blockCount));
+    stats_.add(Stat::BytesOut, kHeaderSize);
+}
+
+void StreamEncoder::appendBlock(std::string& out, std::string_view block) const {
+    if (block.empty() || block.size() > options_.blockSize) {
+        throw std::invalid_argument("Block must hold 1 to blockSize bytes");
+    }
+    std::optional<CodeTable> previous;
+    encodeBlock(out, block, previous, false);
+}
+
+void StreamEncoder::appendIndex(std::string& out, const std::vector<BlockLocation>& blocks,
+                                std::uint64_t indexOffset) const {
+    writeIndex(out, blocks, indexOffset);
+}
+
+template <typename Out>
+void StreamEncoder::writeIndex(Out& out, const std::vector<BlockLocation>& blocks,
+                               std::uint64_t indexOffset) const {
+    for (const auto& entry : blocks) {
+        appendU64(out, entry.rawOffset);
+        appendU64(out, entry.streamOffset);
+    }
+    appendU64(out, indexOffset);
+    appendU32(out, static_cast<std::uint32_t>(blocks.size()));
+    out.append(kIndexMagic);
+    stats_.add(Stat::BytesOut, std::size_t{16} * blocks.size() + kIndexFooterSize);
+}
+
+template <typename Out>
+void StreamEncoder::encodeBlock(Out& out, std::string_view block,
+                                std::optional<CodeTable>& previous, bool blocksFollow) const {
+    const std::size_t blockStart = out.size();
+    stats_.add(Stat::Blocks, 1);
+    stats_.add(Stat::BytesIn, block.size());
+
+    // The first table of a stream is an investment when later blocks may
+    // repeat it, so it is not charged to this block. Small blocks could
+    // otherwise never pay for a table and nothing would ever be repeated.
+    const bool seedTable = options_.reuseTables && !previous.has_value() && blocksFollow;
+    const bool tableMayBeFree = seedTable || (options_.reuseTables && previous.has_value());
+
+    // A sampled estimate lets incompressible blocks skip tree building when
+    // no model other than order-0 could beat raw storage. When the table may
+    // cost nothing only the estimated payload has to beat it.
+    const bool order0Only = options_.contextTables == 0 && !options_.runLength &&
+                            options_.lz77Level == 0 && !options_.bwt;
+    bool incompressible = false;
+    Histogram histogram{};
+    {
+        const StageTimer timer(stats_, Stat::HistogramNs);
+        const std::uint64_t freeTableBytes = tableMayBeFree ? 256 : 0;
+        incompressible =
+            order0Only && estimateCompressedSize(block) - freeTableBytes >= block.size();
+        if (!incompressible) {
+            histogram = computeHistogramParallel(block);
+        }
+    }
+    if (incompressible) {
+        const StageTimer timer(stats_, Stat::EncodeNs);
+        encodeStoredBlock(out, block);
+        stats_.add(Stat::StoredBlocks, 1);
+        stats_.add(Stat::BytesOut, out.size() - blockStart);
+        return;
+    }
+
+    HuffmanTree tree;
+    CodeTable table;
+    {
+        const StageTimer timer(stats_, Stat::BuildNs);
+        tree.buildTree(histogram);
+        table = CodeTable::fromTree(tree);
+    }
+    // Everything from here on, candidate models included, counts as encoding
+    const StageTimer timer(stats_, Stat::EncodeNs);
+
+    // Other models are used only when they win after paying for their tables
+    std::uint64_t bestBits = seedTable ? 0 : 8 * 256;
+    std::uint64_t repeatBits = 0;
+    bool repeatable = options_.reuseTables && previous.has_value();
+    for (const auto& [ch, freq] : tree.getFrequencies()) {
+        const auto symbol = static_cast<unsigned char>(ch);
+        bestBits += static_cast<std::uint64_t>(freq) * table.lengths()[symbol];
+        if (repeatable) {
+            const unsigned length = previous->lengths()[symbol];
+            repeatable = length != 0;
+            repeatBits += static_cast<std::uint64_t>(freq) * length;
+        }
+    }
+    // Candidate blocks are encoded as they take the lead; the winner is kept
+    std::string best;
+    BlockType bestType = BlockType::Huffman;
+    auto consider = [&](std::uint64_t bits, BlockType type, auto&& encode) {
+        if (bits < bestBits) {
+            bestBits = bits;
+            bestType = type;
+            best.clear();
+            encode(best);
+        }
+    };
+    consider(std::uint64_t{8} * block.size(), BlockType::Stored,
+             [&](std::string& dst) { encodeStoredBlock(dst, block); });
+    if (repeatable) {
+        // The previous table covers every byte here and costs no header
+        consider(repeatBits, BlockType::RepeatHuffman, [&](std::string& dst) {
+            encodeHuffmanBlock(dst, block, *previous, BlockType::RepeatHuffman);
+        });
+    }
+    if (options_.contextTables > 0) {
+        const ContextModel model = ContextModel::build(block, options_.contextTables);
+        consider(model.encodedBits() + 8 * (1 + 256 * (model.tables().size() + 1)),
+                 BlockType::ContextHuffman,
+                 [&](std::string& dst) { encodeContextBlock(dst, block, model); });
+    }
+    if (options_.runLength) {
+        const std::vector<std::uint16_t> tokens = runLengthTokens(block);
+        const RunLengthModel model = RunLengthModel::build(tokens);
+        consider(model.encodedBits() + 8 * RunLengthModel::kAlphabetSize,
+                 BlockType::RunLengthHuffman,
+                 [&](std::string& dst) { encodeRunLengthBlock(dst, block, tokens, model); });
+    }
+    if (options_.lz77Level > 0) {
+        const std::vector<Lz77Token> tokens =
+            parseLz77(block, {options_.lz77WindowBits, options_.lz77Level});
+        const Lz77Model model = Lz77Model::build(tokens);
+        consider(model.encodedBits() + 8 * (Lz77Model::kLiteralSymbols + Lz77Model::kLengthSymbols +
+                                            Lz77Model::kDistanceSymbols),
+                 BlockType::Lz77Huffman,
+                 [&](std::string& dst) { encodeLz77Block(dst, block, tokens, model); });
+    }
+    if (options_.bwt) {
+        const std::vector<std::uint16_t> tokens = zeroRunTokens(bwtPipeline().forward(block));
+        const MultiTableModel model =
+            MultiTableModel::build(tokens, RunLengthModel::kAlphabetSize);
+        consider(model.encodedBits() + 8 * (5 + RunLengthModel::kAlphabetSize * model.tables().size()),
+                 BlockType::BwtHuffman,
+                 [&](std::string& dst) { encodeBwtBlock(dst, block, tokens, model); });
+    }
+    if (!best.empty()) {
+        out.append(best);
+    } else {
+        encodeHuffmanBlock(out, block, table, BlockType::Huffman);
+        previous = table;
+    }
+    stats_.add(blockStat(bestType), 1);
+    stats_.add(Stat::BytesOut, out.size() - blockStart);
+}
+
+template <typename Out>
+void StreamEncoder::encodeHuffmanBlock(Out& out, std::string_view block,
+                                       const CodeTable& table, BlockType type) const {
+    // Encode in sync-interval chunks so the bit offset of every chunk start
+    // can be recorded on the way.
+    const std::size_t interval = options_.syncInterval;
+    const std::size_t chunk = interval != 0 ? interval : block.size();
+    std::vector<std::uint64_t> syncOffsets;
+    BitWriter writer;
+    writer.reserveBytes(block.size() * table.maxLength() / 8 + 8);
+    for (std::size_t pos = 0; pos < block.size(); pos += chunk) {
+        if (pos != 0) {
+            syncOffsets.push_back(writer.bitCount());
+        }
+        table.encodeTo(writer, block.substr(pos, chunk));
+    }
+    const std::uint64_t bitCount = writer.bitCount();
+    const std::string payload = writer.finish();
+
+    appendU8(out, static_cast<std::uint8_t>(type));
+    appendU32(out, static_cast<std::uint32_t>(block.size()));
+    if (type == BlockType::Huffman) {
+        for (auto len : table.lengths()) {
+            appendU8(out, len);
+        }
+    }
+    appendU64(out, bitCount);
+    appendU32(out, static_cast<std::uint32_t>(interval));
+    appendU32(out, static_cast<std::uint32_t>(syncOffsets.size()));
+    for (auto offset : syncOffsets) {
+        appendU64(out, offset);
+    }
+    out.append(payload);
+}
+
+void StreamEncoder::encodeContextBlock(std::string& out, std::string_view block,
+                                       const ContextModel& model) const {
+    BitWriter writer;
+    writer.reserveBytes(static_cast<std::size_t>(model.encodedBits() / 8 + 8));
+    model.encodeTo(writer, block);
+    const std::uint64_t bitCount = writer.bitCount();
+    const std::string payload = writer.finish();
+
+    appendU8(out, static_cast<std::uint8_t>(BlockType::ContextHuffman));
+    appendU32(out, static_cast<std::uint32_t>(block.size()));
+    appendU8(out, static_cast<std::uint8_t>(model.tables().size() - 1));
+    for (auto t : model.tableOf()) {
+        appendU8(out, t);
+    }
+    for (const auto& table : model.tables()) {
+        for (auto len : table.lengths()) {
+            appendU8(out, len);
+        }
+    }
+    appendU64(out, bitCount);
+    appendU32(out, 0);  // No sync points: each symbol depends on the previous one
+    appendU32(out, 0);
+    out.append(payload);
+}
+
+void StreamEncoder::encodeLz77Block(std::string& out, std::string_view block,
+                                    const std::vector<Lz77Token>& tokens,
+                                    const Lz77Model& model) const {
+    BitWriter writer;
+    writer.reserveBytes(static_cast<std::size_t>(model.encodedBits() / 8 + 8));
+    model.encodeTo(writer, tokens);
+    const std::uint64_t bitCount = writer.bitCount();
+    const std::string payload = writer.finish();
+
+    appendU8(out, static_cast<std::uint8_t>(BlockType::Lz77Huffman));
+    appendU32(out, static_cast<std::uint32_t>(block.size()));
+    for (const CodeTable* table : {&model.literals(), &model.lengths(), &model.distances()}) {
+        for (auto len : table->lengths()) {
+            appendU8(out, len);
+        }
+    }
+    appendU64(out, bitCount);
+    appendU32(out, 0);  // No sync points: matches refer back across the block
+    appendU32(out, 0);
+    out.append(payload);
+}
+
+void StreamEncoder::encodeRunLengthBlock(std::string& out, std::string_view block,
+                                         const std::vector<std::uint16_t>& tokens,
+                                         const RunLengthModel& model) const {
+    BitWriter writer;
+    writer.reserveBytes(static_cast<std::size_t>(model.encodedBits() / 8 + 8));
+    model.encodeTo(writer, tokens);
+    const std::uint64_t bitCount = writer.bitCount();
+    const std::string payload = writer.finish();
+
+    appendU8(out, static_cast<std::uint8_t>(BlockType::RunLengthHuffman));
+    appendU32(out, static_cast<std::uint32_t>(block.size()));
+    for (auto len : model.table().lengths()) {
+        appendU8(out, len);
+    }
+    appendU64(out, bitCount);
+    appendU32(out, 0);  // No sync points: runs repeat the byte before them
+    appendU32(out, 0);
+    out.append(payload);
+}
+
+template <typename Out>
+void StreamEncoder::encodeStoredBlock(Out& out, std::string_view block) const {
+    appendU8(out, static_cast<std::uint8_t>(BlockType::Stored));
+    appendU32(out, static_cast<std::uint32_t>(block.size()));
+    appendU64(out, std::uint64_t{8} * block.size());
+    appendU32(out, 0);
+    appendU32(out, 0);
+    out.append(block);
+}
+
+void StreamEncoder::encodeBwtBlock(std::string& out, std::string_view block,
+                                   const std::vector<std::uint16_t>& tokens,
+                                   const MultiTableModel& model) const {
+    BitWriter writer;
+    writer.reserveBytes(static_cast<std::size_t>(model.encodedBits() / 8 + 8));
+    model.encodeTo(writer, tokens);
+    const std::uint64_t bitCount = writer.bitCount();
+    const std::string payload = writer.finish();
+
+    appendU8(out, static_cast<std::uint8_t>(BlockType::BwtHuffman));
+    appendU32(out, static_cast<std::uint32_t>(block.size()));
+    appendU32(out, static_cast<std::uint32_t>(tokens.size()));
+    appendU8(out, static_cast<std::uint8_t>(model.tables().size()));
+    for (const auto& table : model.tables()) {
+        for (auto len : table.lengths()) {
+            appendU8(out, len);
+        }
+    }
+    appendU64(out, bitCount);
+    appendU32(out, 0);  // No sync points: the BWT needs the whole block
+    appendU32(out, 0);
+    out.append(payload);
+}
+
+StreamDecoder::StreamDecoder(unsigned threads, DecodeKernel kernel)
+    : threads_(threads), kernel_(kernel) {
+    if (!isKernelSupported(kernel_)) {
+        throw std::invalid_argument(
+            std::string("Decode kernel not supported on this CPU: ") + kernelName(kernel_));
+    }
+}
+
+std::uint64_t StreamDecoder::decodedSize(std::string_view stream) {
+    ByteReader reader(stream);
+    return parseHeader(reader).totalSize;
+}
+
+std::string StreamDecoder::decode(std::string_view stream) const {
+    std::string out(static_cast<std::size_t>(decodedSize(stream)), '\0');
+    decodeInto(stream, out.data(), out.size());
+    return out;
+}
+
+std::size_t StreamDecoder::decodeInto(std::string_view stream, char* out,
+                                      std::size_t capacity) const {
+    ByteReader reader(stream);
+    const StreamHeader header = parseHeader(reader);
+    const std::uint64_t totalSize = header.totalSize;
+    if (totalSize > capacity) {
+        throw std::invalid_argument("Output buffer too small for the decoded stream");
+    }
+    const std::uint32_t blockCount = header.blockCount;
+
+    std::vector<ParsedBlock> blocks;
+    blocks.reserve(blockCount);
+    // Table source of each block: itself, or the Huffman block it repeats
+    std::vector<std::size_t> tableSource(blockCount);
+    std::size_t lastTable = blockCount;
+    std::uint64_t outputOffset = 0;
+    for (std::uint32_t i = 0; i < blockCount; ++i) {
+        ParsedBlock& block = blocks.emplace_back(parseBlock(reader));
+        block.outputOffset = static_cast<std::size_t>(outputOffset);
+        outputOffset += block.rawSize;
+        tableSource[i] = i;
+        if (block.type == BlockType::Huffman) {
+            lastTable = i;
+        } else if (block.type == BlockType::RepeatHuffman) {
+            if (lastTable == blockCount) {
+                throw std::runtime_error("Invalid stream: repeated table without an earlier one");
+            }
+            tableSource[i] = lastTable;
+            block.lengths = blocks[lastTable].lengths;
+        }
+    }
+    if (outputOffset != totalSize) {
+        throw std::runtime_error("Invalid stream: block sizes do not match total size");
+    }
+    if (header.flags & kFlagBlockIndex) {
+        if (parseIndex(stream, header).size() != blocks.size() ||
+            reader.remaining() != std::size_t{16} * blocks.size() + kIndexFooterSize) {
+            throw std::runtime_error("Invalid stream: bad block index");
+        }
+    } else if (reader.remaining() != 0) {
+        throw std::runtime_error("Invalid stream: trailing data");
+    }
+    stats_.add(Stat::BytesIn, stream.size());
+    stats_.add(Stat::BytesOut, totalSize);
+    stats_.add(Stat::Blocks, blocks.size());
+    for (const ParsedBlock& block : blocks) {
+        stats_.add(blockStat(block.type), 1);
+    }
+
+    // With fewer blocks than workers, blocks without a sync-point index are
+    // decoded speculatively so that they can still use several threads.
+    const unsigned workers = resolveThreadCount(threads_);
+    std::vector<std::size_t> speculative;
+
+    // Split every other block at its sync points
+    std::vector<Segment> segments;
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        const ParsedBlock& block = blocks[b];
+        if (workers > 1 && blocks.size() < workers && usesOrder0Table(block.type) &&
+            block.syncOffsets.empty() && block.bitCount >= 2 * kSpeculativeMinChunkBits) {
+            speculative.push_back(b);
+            continue;
+        }
+        std::uint64_t bitBegin = 0;
+        std::size_t symbol = 0;
+        for (std::size_t i = 0; i <= block.syncOffsets.size(); ++i) {
+            const bool last = i == block.syncOffsets.size();
+            const std::uint64_t bitEnd = last ? block.bitCount : block.syncOffsets[i];
+            const std::size_t count = last ? block.rawSize - symbol : block.syncInterval;
+            segments.push_back({b, block.outputOffset + symbol, count, bitBegin, bitEnd});
+            bitBegin = bitEnd;
+            symbol += count;
+        }
+    }
+
+    // Repeated tables share the decoder built for their source block
+    std::vector<BlockDecoder> decoders(blocks.size());
+    {
+        const StageTimer timer(stats_, Stat::BuildNs);
+        parallelFor(blocks.size(), threads_, [&](std::size_t b) {
+            if (tableSource[b] == b) decoders[b] = makeBlockDecoder(blocks[b]);
+        });
+    }
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        if (tableSource[b] != b && blocks[b].rawSize != 0) {
+            decoders[b].table = decoders[tableSource[b]].table;
+            // Empty blocks get no decoder, so they cannot lend a table
+            if (!decoders[b].table) {
+                throw std::runtime_error("Invalid stream: repeated table from an empty block");
+            }
+        }
+    }
+
+    const StageTimer timer(stats_, Stat::DecodeNs);
+    parallelFor(segments.size(), threads_, [&](std::size_t s) {
+        const Segment& seg = segments[s];
+        if (seg.symbolCount == 0) return;
+        const ParsedBlock& block = blocks[seg.block];
+        if (!usesOrder0Table(block.type)) {
+            decoders[seg.block].decodeWhole(block, out + seg.outputOffset);
+            return;
+        }
+        decoders[seg.block].table->decodeInto(out + seg.outputOffset, seg.symbolCount,
+                                        blocks[seg.block].payload,
+                                        static_cast<std::size_t>(seg.bitBegin),
+                                        static_cast<std::size_t>(seg.bitEnd), kernel_);
+    });
+
+    for (std::size_t b : speculative) {
+        const ParsedBlock& block = blocks[b];
+        const std::string decoded = decodeSpeculative(
+            *decoders[b].table, block.payload, static_cast<std::size_t>(block.bitCount),
+            block.rawSize, threads_, kernel_);
+        std::memcpy(out + block.outputOffset, decoded.data(), decoded.size());
+    }
+    return static_cast<std::size_t>(totalSize);
+}
+
+std::string StreamDecoder::readAt(std::string_view stream, std::uint64_t offset,
+                                  std::size_t length) const {
+    ByteReader reader(stream);
+    const StreamHeader header = parseHeader(reader);
+    if (offset > header.totalSize || length > header.totalSize - offset) {
+        throw std::invalid_argument("Requested range exceeds stream size");
+    }
+    const std::uint64_t end = offset + length;
+
+    // Locate the first block that covers `offset`: through the index when
+    // present, otherwise by walking block headers without decoding them.
+    std::uint64_t blockStart = 0;
+    std::vector<BlockLocation> index;
+    std::size_t indexPos = 0;
+    if (header.flags & kFlagBlockIndex) {
+        index = parseIndex(stream, header);
+        auto it = std::upper_bound(index.begin(), index.end(), offset,
+                                   [](std::uint64_t value, const BlockLocation& entry) {
+                                       return value < entry.rawOffset;
+                                   });
+        if (it != index.begin()) {
+            --it;
+            reader = ByteReader(stream);
+            (void)reader.bytes(static_cast<std::size_t>(it->streamOffset));
+            blockStart = it->rawOffset;
+            indexPos = static_cast<std::size_t>(it - index.begin());
+        }
+    }
+
+    // Code lengths of the nearest earlier Huffman block, for repeat blocks;
+    // after an index seek they are found by stepping back through the index
+    std::vector<std::uint8_t> lastLengths;
+    auto earlierLengths = [&]() {
+        for (std::size_t i = indexPos; i-- > 0;) {
+            ByteReader back(stream);
+            (void)back.bytes(static_cast<std::size_t>(index[i].streamOffset));
+            const ParsedBlock earlier = parseBlock(back);
+            if (earlier.type == BlockType::Huffman) return earlier.lengths;
+        }
+        throw std::runtime_error("Invalid stream: repeated table without an earlier one");
+    };
+
+    std::string out;
+    out.reserve(length);
+    while (out.size() < length) {
+        ParsedBlock block = parseBlock(reader);
+        if (block.type == BlockType::Huffman) {
+            lastLengths = block.lengths;
+        } else if (block.type == BlockType::RepeatHuffman) {
+            if (lastLengths.empty()) lastLengths = earlierLengths();
+            block.lengths = lastLengths;
+        }
+        const std::uint64_t blockEnd = blockStart + block.rawSize;
+        if (blockEnd > offset && block.rawSize != 0) {
+            const std::size_t localBegin =
+                static_cast<std::size_t>(std::max(offset, blockStart) - blockStart);
+            const std::size_t localEnd =
+                static_cast<std::size_t>(std::min(end, blockEnd) - blockStart);
+
+            // Start at the last sync point before the range, if any
+            std::size_t first = 0;
+            std::size_t bitBegin = 0;
+            if (block.syncInterval != 0 && localBegin >= block.syncInterval) {
+                const std::size_t point = localBegin / block.syncInterval;
+                first = point * block.syncInterval;
+                bitBegin = static_cast<std::size_t>(block.syncOffsets.at(point - 1));
+            }
+
+            if (block.type == BlockType::Stored) {
+                out.append(block.payload.substr(localBegin, localEnd - localBegin));
+                blockStart = blockEnd;
+                continue;
+            }
+
+            const BlockDecoder decoder = makeBlockDecoder(block);
+            std::string decoded;
+            if (!usesOrder0Table(block.type)) {
+                decoded.resize(block.rawSize);
+                decoder.decodeWhole(block, decoded.data());
+                decoded.resize(localEnd);
+            } else {
+                BitReader bits(block.payload, bitBegin, static_cast<std::size_t>(block.bitCount));
+                decoded.resize(localEnd - first);
+                if (decoder.table->decodeUntil(bits, decoded.data(), decoded.size(),
+                                               static_cast<std::size_t>(block.bitCount),
+                                               kernel_) != decoded.size()) {
+                    throw std::runtime_error("Invalid stream: block shorter than its header claims");
+                }
+            }
+            out.append(decoded, localBegin - first, std::string::npos);
+        }
+        blockStart = blockEnd;
+    }
+    return out;
+}
+
+} // namespace huffman
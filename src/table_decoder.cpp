@@ -0,0 +1,334 @@
+#include "table_decoder.h"
+
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+constexpr std::array<std::uint8_t, 256> kReverse8 = [] {
+    std::array<std::uint8_t, 256> table{};
+    for (unsigned i = 0; i < 256; ++i) {
+        unsigned r = 0;
+        for (unsigned b = 0; b < 8; ++b) {
+            r |= ((i >> b) & 1u) << (7 - b);
+        }
+        table[i] = static_cast<std::uint8_t>(r);
+    }
+    return table;
+}();
+
+// First 16 stream bits as a left-aligned (MSB-first) window
+[[nodiscard]] inline std::uint32_t reverse16(std::uint64_t bits) noexcept {
+    return (static_cast<std::uint32_t>(kReverse8[bits & 0xFF]) << 8) |
+           kReverse8[(bits >> 8) & 0xFF];
+}
+
+} // namespace
+
+bool isKernelSupported(DecodeKernel kernel) noexcept {
+    switch (kernel) {
+    case DecodeKernel::Generic:
+        return true;
+    case DecodeKernel::Bmi2:
+        return cpuHasBmi2();
+    }
+    return false;
+}
+
+DecodeKernel detectDecodeKernel() noexcept {
+    static const DecodeKernel best =
+        isKernelSupported(DecodeKernel::Bmi2) ? DecodeKernel::Bmi2 : DecodeKernel::Generic;
+    return best;
+}
+
+const char* kernelName(DecodeKernel kernel) noexcept {
+    switch (kernel) {
+    case DecodeKernel::Generic: return "generic";
+    case DecodeKernel::Bmi2: return "bmi2";
+    }
+    return "unknown";
+}
+
+TableDecoder::TableDecoder(const CodeTable& table, TableDecoderOptions options)
+    : counts_(table.lengthCounts()),
+      sorted_(table.sortedSymbols()),
+      tableBits_(options.tableBits),
+      maxSymbols_(options.maxSymbolsPerEntry),
+      maxLength_(table.maxLength()),
+      alphabetSize_(table.alphabetSize()) {
+    if (table.empty()) {
+        throw std::invalid_argument("Code table is empty");
+    }
+    if (tableBits_ == 0 || tableBits_ > CodeTable::kMaxCodeLength) {
+        throw std::invalid_argument("Table bits must be between 1 and 16");
+    }
+    if (maxSymbols_ == 0 || maxSymbols_ > 4) {
+        throw std::invalid_argument("Symbols per entry must be between 1 and 4");
+    }
+    if (alphabetSize_ > 256) {
+        maxSymbols_ = 1;
+    }
+
+    // Single-symbol entries: every index whose low bits hold a complete code
+    const std::size_t size = std::size_t{1} << tableBits_;
+    std::vector<Entry> single(size);
+    for (std::size_t sym = 0; sym < alphabetSize_; ++sym) {
+        const Code& code = table.code(sym);
+        if (code.length == 0 || code.length > tableBits_) continue;
+        const std::uint32_t reversed = reverseBits(code.bits, code.length);
+        for (std::size_t i = reversed; i < size; i += std::size_t{1} << code.length) {
+            single[i] = Entry{static_cast<std::uint32_t>(sym), 1, code.length};
+        }
+    }
+
+    // Comparison tables for canonical resolution of long codes
+    constexpr unsigned kWindow = CodeTable::kMaxCodeLength;
+    firstCode_.assign(kWindow + 2, 0);
+    limit_.assign(kWindow + 1, 0);
+    offset_.assign(kWindow + 1, 0);
+    std::uint32_t first = 0;
+    std::uint16_t offset = 0;
+    for (unsigned len = 1; len <= kWindow; ++len) {
+        firstCode_[len] = first;
+        offset_[len] = offset;
+        limit_[len] = (first + counts_[len]) << (kWindow - len);
+        offset = static_cast<std::uint16_t>(offset + counts_[len]);
+        first = (first + counts_[len]) << 1;
+    }
+    startLength_.assign(kWindow + 1, 0);
+    for (unsigned ones = 0; ones <= kWindow; ++ones) {
+        const std::uint32_t base = ((std::uint32_t{1} << ones) - 1) << (kWindow - ones);
+        unsigned len = 1;
+        while (len <= maxLength_ && limit_[len] <= base) ++len;
+        startLength_[ones] = static_cast<std::uint8_t>(len);
+    }
+
+    if (maxSymbols_ == 1) {
+        table_ = std::move(single);
+        return;
+    }
+
+    // Multi-symbol entries: keep appending symbols while the next code fits
+    // entirely within the index bits that remain after the previous ones.
+    table_.resize(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        Entry entry = single[i];
+        if (entry.count == 0) continue;
+        while (entry.count < maxSymbols_) {
+            const unsigned used = entry.length;
+            const Entry& next = single[i >> used];
+            if (next.count == 0 || next.length > tableBits_ - used) break;
+            entry.symbols |= next.symbols << (8 * entry.count);
+            ++entry.count;
+            entry.length = static_cast<std::uint8_t>(used + next.length);
+        }
+        table_[i] = entry;
+    }
+}
+
+unsigned TableDecoder::decodeCanonical(std::uint64_t window, unsigned limit,
+                                       std::uint32_t& symbol) const noexcept {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (unsigned len = 1; len <= limit; ++len) {
+        code |= static_cast<int>((window >> (len - 1)) & 1u);
+        const int count = counts_[len];
+        if (code - count < first) {
+            symbol = sorted_[static_cast<std::size_t>(index + (code - first))];
+            return len;
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return 0;
+}
+
+// Always inlined so the BMI2 kernel compiles the leading-ones count as tzcnt
+HUFFMAN_ALWAYS_INLINE unsigned TableDecoder::decodeCanonicalHinted(
+    std::uint64_t window, std::uint32_t& symbol) const noexcept {
+    constexpr unsigned kWindow = CodeTable::kMaxCodeLength;
+    // Leading ones of the code are the trailing ones of the LSB-first window
+    const unsigned ones = countTrailingZeros(~window | (std::uint64_t{1} << kWindow));
+    const std::uint32_t code16 = reverse16(window);
+    for (unsigned len = startLength_[ones]; len <= maxLength_; ++len) {
+        if (code16 < limit_[len]) {
+            const std::uint32_t code = code16 >> (kWindow - len);
+            symbol = sorted_[offset_[len] + (code - firstCode_[len])];
+            return len;
+        }
+    }
+    return 0;
+}
+
+std::uint32_t TableDecoder::decodeSymbol(BitReader& reader) const {
+    reader.refill();
+    const std::size_t remaining = reader.bitsRemaining();
+    if (remaining == 0) {
+        throw std::runtime_error("Invalid encoded data: unexpected end of stream");
+    }
+
+    if (maxSymbols_ == 1) {
+        const Entry& entry = table_[reader.peek(tableBits_)];
+        if (entry.count != 0 && entry.length <= remaining) {
+            reader.consume(entry.length);
+            return entry.symbols;
+        }
+    }
+
+    const unsigned limit = static_cast<unsigned>(std::min<std::size_t>(maxLength_, remaining));
+    std::uint32_t symbol = 0;
+    const unsigned len = decodeCanonical(reader.peek(limit), limit, symbol);
+    if (len == 0) {
+        throw std::runtime_error("Invalid encoded data: no matching code");
+    }
+    reader.consume(len);
+    return symbol;
+}
+
+std::string TableDecoder::decode(const PackedBits& packed) const {
+    return decode(packed.bytes, packed.bitCount, packed.symbolCount);
+}
+
+std::string TableDecoder::decode(std::string_view bytes, std::size_t bitCount,
+                                 std::size_t symbolCount) const {
+    return decode(bytes, bitCount, symbolCount, detectDecodeKernel());
+}
+
+HUFFMAN_ALWAYS_INLINE void TableDecoder::decodeFast(
+    BitReader& reader, char*& dst, char* end, std::size_t stopBit) const {
+    // Work on local copies: stores through `out` may alias anything, which
+    // would otherwise force the bit buffer and table pointer back to memory.
+    BitReader bits = reader;
+    char* out = dst;
+    const Entry* const table = table_.data();
+    const unsigned tableBits = tableBits_;
+    const std::size_t stepBits = std::max(tableBits_, maxLength_);
+    const std::size_t stepSymbols = maxSymbols_;
+
+    auto step = [&]() {
+        const Entry entry = table[bits.peek(tableBits)];
+        if (entry.count != 0) {
+            for (unsigned k = 0; k < 4; ++k) {
+                out[k] = static_cast<char>((entry.symbols >> (8 * k)) & 0xFF);
+            }
+            out += entry.count;
+            bits.consume(entry.length);
+            return;
+        }
+        std::uint32_t symbol = 0;
+        const unsigned len = decodeCanonicalHinted(bits.buffer(), symbol);
+        if (len == 0) {
+            throw std::runtime_error("Invalid encoded data: no matching code");
+        }
+        *out++ = static_cast<char>(symbol);
+        bits.consume(len);
+    };
+
+    // Two lookups per refill while both are guaranteed to stay inside the
+    // stream, and both four-byte stores inside the output.
+    while (bits.position() + 2 * stepBits <= stopBit &&
+           static_cast<std::size_t>(end - out) >= stepSymbols + 4) {
+        bits.refill();
+        step();
+        step();
+    }
+
+    reader = bits;
+    dst = out;
+}
+
+void TableDecoder::decodeFastGeneric(BitReader& reader, char*& dst, char* end,
+                                     std::size_t stopBit) const {
+    decodeFast(reader, dst, end, stopBit);
+}
+
+#ifdef HUFFMAN_X86_DISPATCH
+// The shared loop is inlined here and compiled for BMI1/BMI2, so peeks become
+// bzhi, consumes shrx and the leading-ones count tzcnt.
+__attribute__((target("bmi,bmi2")))
+void TableDecoder::decodeFastBmi2(BitReader& reader, char*& dst, char* end,
+                                  std::size_t stopBit) const {
+    decodeFast(reader, dst, end, stopBit);
+}
+#else
+void TableDecoder::decodeFastBmi2(BitReader& reader, char*& dst, char* end,
+                                  std::size_t stopBit) const {
+    decodeFast(reader, dst, end, stopBit);
+}
+#endif
+
+void TableDecoder::decodeFastDispatch(BitReader& reader, char*& dst, char* end,
+                                      std::size_t stopBit, DecodeKernel kernel) const {
+    if (kernel == DecodeKernel::Bmi2) {
+        decodeFastBmi2(reader, dst, end, stopBit);
+    } else {
+        decodeFastGeneric(reader, dst, end, stopBit);
+    }
+}
+
+std::string TableDecoder::decode(std::string_view bytes, std::size_t bitCount,
+                                 std::size_t symbolCount, DecodeKernel kernel) const {
+    std::string out(symbolCount, '\0');
+    decodeInto(out.data(), symbolCount, bytes, 0, bitCount, kernel);
+    return out;
+}
+
+void TableDecoder::decodeInto(char* out, std::size_t symbolCount, std::string_view bytes,
+                              std::size_t bitBegin, std::size_t bitEnd,
+                              DecodeKernel kernel) const {
+    if (alphabetSize_ > 256) {
+        throw std::invalid_argument("Byte decoding requires an alphabet of at most 256 symbols");
+    }
+    if (bitBegin > bitEnd || bitEnd > bytes.size() * 8) {
+        throw std::invalid_argument("Bit range exceeds input size");
+    }
+    if (!isKernelSupported(kernel)) {
+        throw std::invalid_argument(
+            std::string("Decode kernel not supported on this CPU: ") + kernelName(kernel));
+    }
+
+    char* dst = out;
+    char* const end = out + symbolCount;
+
+    BitReader reader(bytes, bitBegin, bitEnd);
+    decodeFastDispatch(reader, dst, end, bitEnd, kernel);
+
+    // Tail: one symbol at a time with exact bounds checks
+    while (dst < end) {
+        *dst++ = static_cast<char>(decodeSymbol(reader));
+    }
+
+    if (reader.bitsRemaining() != 0) {
+        throw std::runtime_error("Invalid encoded data: trailing bits after last symbol");
+    }
+}
+
+std::size_t TableDecoder::decodeUntil(BitReader& reader, char* out, std::size_t capacity,
+                                      std::size_t stopBit, DecodeKernel kernel) const {
+    if (alphabetSize_ > 256) {
+        throw std::invalid_argument("Byte decoding requires an alphabet of at most 256 symbols");
+    }
+    if (!isKernelSupported(kernel)) {
+        throw std::invalid_argument(
+            std::string("Decode kernel not supported on this CPU: ") + kernelName(kernel));
+    }
+
+    char* dst = out;
+    char* const end = out + capacity;
+    const std::size_t fastStop = std::min(stopBit, reader.position() + reader.bitsRemaining());
+    decodeFastDispatch(reader, dst, end, fastStop, kernel);
+    while (dst < end && reader.position() < stopBit) {
+        *dst++ = static_cast<char>(decodeSymbol(reader));
+    }
+    return static_cast<std::size_t>(dst - out);
+}
+
+} // namespace huffman
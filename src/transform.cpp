@@ -0,0 +1,82 @@
+#include "transform.h"
+
+#include "bwt.h"
+#include "byte_io.h"
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+
+namespace huffman {
+
+std::string moveToFront(std::string_view data) {
+    std::array<unsigned char, 256> order{};
+    std::iota(order.begin(), order.end(), static_cast<unsigned char>(0));
+    std::string out(data.size(), '\0');
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        const auto byte = static_cast<unsigned char>(data[i]);
+        std::size_t index = 0;
+        while (order[index] != byte) ++index;
+        for (std::size_t j = index; j > 0; --j) order[j] = order[j - 1];
+        order[0] = byte;
+        out[i] = static_cast<char>(index);
+    }
+    return out;
+}
+
+std::string inverseMoveToFront(std::string_view data) {
+    std::array<unsigned char, 256> order{};
+    std::iota(order.begin(), order.end(), static_cast<unsigned char>(0));
+    std::string out(data.size(), '\0');
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        const auto index = static_cast<unsigned char>(data[i]);
+        const unsigned char byte = order[index];
+        for (std::size_t j = index; j > 0; --j) order[j] = order[j - 1];
+        order[0] = byte;
+        out[i] = static_cast<char>(byte);
+    }
+    return out;
+}
+
+TransformPipeline::TransformPipeline(std::vector<TransformStage> stages)
+    : stages_(std::move(stages)) {}
+
+std::string TransformPipeline::forward(std::string_view data) const {
+    std::string current(data);
+    for (TransformStage stage : stages_) {
+        switch (stage) {
+        case TransformStage::Bwt: {
+            BwtBlock block = bwtForward(current);
+            current.clear();
+            appendU32(current, block.primaryIndex);
+            current += block.data;
+            break;
+        }
+        case TransformStage::MoveToFront:
+            current = moveToFront(current);
+            break;
+        }
+    }
+    return current;
+}
+
+std::string TransformPipeline::inverse(std::string_view data) const {
+    std::string current(data);
+    for (auto it = stages_.rbegin(); it != stages_.rend(); ++it) {
+        switch (*it) {
+        case TransformStage::Bwt: {
+            ByteReader reader(current);
+            const std::uint32_t primaryIndex = reader.u32();
+            current = bwtInverse(std::string_view(current).substr(4), primaryIndex);
+            break;
+        }
+        case TransformStage::MoveToFront:
+            current = inverseMoveToFront(current);
+            break;
+        }
+    }
+    return current;
+}
+
+} // namespace huffman
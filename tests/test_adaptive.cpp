@@ -0,0 +1,91 @@
+#include "adaptive.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::string roundtrip(const std::string& input) {
+    huffman::AdaptiveHuffmanEncoder encoder;
+    encoder.encode(input);
+    return huffman::AdaptiveHuffmanDecoder().decode(encoder.finish());
+}
+
+} // namespace
+
+TEST(test_adaptive_roundtrip) {
+    ASSERT_EQ(roundtrip("hello world"), "hello world");
+    ASSERT_EQ(roundtrip("a"), "a");
+    ASSERT_EQ(roundtrip(""), "");
+
+    std::string all;
+    for (int i = 0; i < 256; ++i) all.push_back(static_cast<char>(i));
+    ASSERT_EQ(roundtrip(all + all), all + all);
+}
+
+TEST(test_adaptive_compresses_skewed_input) {
+    std::string input;
+    for (int i = 0; i < 1000; ++i) {
+        input += "The quick brown fox jumps over the lazy dog. ";
+    }
+    huffman::AdaptiveHuffmanEncoder encoder;
+    encoder.encode(input);
+    auto packed = encoder.finish();
+
+    ASSERT_TRUE(packed.bitCount < input.size() * 5);
+    ASSERT_EQ(huffman::AdaptiveHuffmanDecoder().decode(packed), input);
+}
+
+TEST(test_adaptive_streaming_chunks) {
+    std::mt19937 rng(11);
+    std::string input(50000, '\0');
+    for (auto& ch : input) {
+        ch = static_cast<char>('a' + std::min(25u, static_cast<unsigned>(rng() % 40)));
+    }
+
+    // Feed in uneven chunks and drain output as it becomes available
+    huffman::AdaptiveHuffmanEncoder encoder;
+    std::string bytes;
+    for (std::size_t pos = 0; pos < input.size(); pos += 777) {
+        encoder.encode(std::string_view(input).substr(pos, 777));
+        bytes += encoder.takeBytes();
+    }
+    auto tail = encoder.finish();
+    bytes += tail.bytes;
+
+    ASSERT_EQ(huffman::AdaptiveHuffmanDecoder().decode(bytes, tail.bitCount, tail.symbolCount),
+              input);
+}
+
+TEST(test_adaptive_truncated_throws) {
+    huffman::AdaptiveHuffmanEncoder encoder;
+    encoder.encode("abcabcabcd");
+    auto packed = encoder.finish();
+
+    huffman::AdaptiveHuffmanDecoder decoder;
+    ASSERT_THROW(decoder.decode(packed.bytes, packed.bitCount - 3, packed.symbolCount),
+                 std::runtime_error);
+    ASSERT_THROW(decoder.decode(packed.bytes, packed.bitCount, packed.symbolCount - 1),
+                 std::runtime_error);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Adaptive Huffman Unit Tests ===\n\n";
+
+    RUN_TEST(test_adaptive_roundtrip);
+    RUN_TEST(test_adaptive_compresses_skewed_input);
+    RUN_TEST(test_adaptive_streaming_chunks);
+    RUN_TEST(test_adaptive_truncated_throws);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include "batch.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Small JSON-ish bus messages of varying length
+std::vector<std::string> busMessages(std::size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> messages;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string msg = "{\"id\":" + std::to_string(rng() % 100000) + ",\"topic\":\"orders\"";
+        const std::size_t extra = rng() % 12;
+        for (std::size_t k = 0; k < extra; ++k) {
+            msg += ",\"f" + std::to_string(k) + "\":" + std::to_string(rng() % 1000);
+        }
+        msg += "}";
+        messages.push_back(i % 50 == 7 ? std::string() : msg);
+    }
+    return messages;
+}
+
+std::vector<std::string_view> views(const std::vector<std::string>& messages) {
+    return std::vector<std::string_view>(messages.begin(), messages.end());
+}
+
+} // namespace
+
+TEST(test_batch_roundtrip) {
+    const auto messages = busMessages(2000, 1);
+    const auto table = huffman::BatchEncoder::train(views(messages));
+    const huffman::BatchEncoder encoder(table);
+    const huffman::EncodedBatch batch = encoder.encode(views(messages));
+    ASSERT_EQ(batch.size(), messages.size());
+
+    std::size_t rawBytes = 0;
+    for (const auto& m : messages) rawBytes += m.size();
+    ASSERT_TRUE(batch.bytes.size() < rawBytes * 3 / 4);
+
+    for (unsigned threads : {1u, 3u}) {
+        const huffman::MessageArena decoded = huffman::BatchDecoder(table, threads).decode(batch);
+        ASSERT_EQ(decoded.size(), messages.size());
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            ASSERT_EQ(decoded[i], messages[i]);
+        }
+    }
+
+    const huffman::BatchDecoder decoder(table);
+    ASSERT_EQ(decoder.decodeMessage(batch, 1234), messages[1234]);
+    ASSERT_EQ(decoder.decodeMessage(batch, 7), "");
+    ASSERT_THROW(static_cast<void>(decoder.decodeMessage(batch, messages.size())),
+                 std::invalid_argument);
+}
+
+TEST(test_batch_shared_table_across_batches) {
+    // A table trained on one batch codes later ones, including unseen bytes
+    const auto first = busMessages(500, 2);
+    const huffman::BatchEncoder encoder(huffman::BatchEncoder::train(views(first)));
+
+    huffman::MessageArena later;
+    later.append("\x01\xFE binary \xFF");
+    for (const auto& m : busMessages(300, 3)) later.append(m);
+
+    const huffman::EncodedBatch batch = encoder.encode(later);
+    const huffman::MessageArena decoded = huffman::BatchDecoder(encoder.table()).decode(batch);
+    ASSERT_EQ(decoded.data, later.data);
+    ASSERT_EQ(decoded.offsets, later.offsets);
+}
+
+TEST(test_batch_empty_and_invalid) {
+    const huffman::BatchEncoder encoder(huffman::BatchEncoder::train({}));
+    const huffman::EncodedBatch empty = encoder.encode(std::vector<std::string_view>{});
+    ASSERT_EQ(empty.size(), 0u);
+    ASSERT_EQ(huffman::BatchDecoder(encoder.table()).decode(empty).size(), 0u);
+
+    ASSERT_THROW(huffman::BatchEncoder(huffman::CodeTable()), std::invalid_argument);
+
+    huffman::EncodedBatch batch = encoder.encode(std::vector<std::string_view>{"abc", "de"});
+    batch.bitOffsets[1] = batch.bitOffsets[2] + 1;
+    ASSERT_THROW(static_cast<void>(huffman::BatchDecoder(encoder.table()).decode(batch)),
+                 std::invalid_argument);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Batch Unit Tests ===\n\n";
+
+    RUN_TEST(test_batch_roundtrip);
+    RUN_TEST(test_batch_shared_table_across_batches);
+    RUN_TEST(test_batch_empty_and_invalid);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
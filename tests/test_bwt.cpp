@@ -0,0 +1,141 @@
+#include "bwt.h"
+#include "multi_table.h"
+#include "run_length.h"
+#include "stream.h"
+#include "test_common.h"
+#include "transform.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::vector<std::uint32_t> naiveSuffixArray(const std::string& s) {
+    std::vector<std::uint32_t> sa(s.size());
+    std::iota(sa.begin(), sa.end(), 0u);
+    std::sort(sa.begin(), sa.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return s.compare(a, std::string::npos, s, b, std::string::npos) < 0;
+    });
+    return sa;
+}
+
+std::string randomText(std::size_t size, unsigned alphabet, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string text(size, '\0');
+    for (auto& ch : text) ch = static_cast<char>('a' + rng() % alphabet);
+    return text;
+}
+
+std::string wordText(std::size_t size) {
+    const std::string words[] = {"compression ", "huffman ", "table ", "the ", "of ",
+                                 "block ", "stream ", "decoder ", "and ", "symbol "};
+    std::mt19937 rng(12);
+    std::string text;
+    while (text.size() < size) text += words[rng() % 10];
+    return text;
+}
+
+} // namespace
+
+TEST(test_suffix_array_matches_naive) {
+    ASSERT_TRUE(huffman::buildSuffixArray("").empty());
+    ASSERT_TRUE(huffman::buildSuffixArray("banana") == naiveSuffixArray("banana"));
+    ASSERT_TRUE(huffman::buildSuffixArray("aaaaaaa") == naiveSuffixArray("aaaaaaa"));
+    for (unsigned seed = 0; seed < 40; ++seed) {
+        const std::string text = randomText(1 + seed * 37, 1 + seed % 5, seed);
+        ASSERT_TRUE(huffman::buildSuffixArray(text) == naiveSuffixArray(text));
+    }
+    std::string binary(3000, '\0');
+    std::mt19937 rng(1);
+    for (auto& ch : binary) ch = static_cast<char>(rng() % 3 == 0 ? 0xFF : 0);
+    ASSERT_TRUE(huffman::buildSuffixArray(binary) == naiveSuffixArray(binary));
+}
+
+TEST(test_bwt_roundtrip) {
+    const auto banana = huffman::bwtForward("banana");
+    ASSERT_EQ(banana.data, "annbaa");
+    ASSERT_EQ(huffman::bwtInverse(banana.data, banana.primaryIndex), "banana");
+
+    for (const std::string& text : {std::string(""), std::string("x"), std::string(1000, 'q'),
+                                    randomText(5000, 3, 7), wordText(20000)}) {
+        const auto block = huffman::bwtForward(text);
+        ASSERT_EQ(huffman::bwtInverse(block.data, block.primaryIndex), text);
+    }
+    ASSERT_THROW((void)huffman::bwtInverse("abc", 0), std::runtime_error);
+    ASSERT_THROW((void)huffman::bwtInverse("abc", 4), std::runtime_error);
+}
+
+TEST(test_pipeline_stages_compose) {
+    const std::string text = wordText(30000);
+    ASSERT_EQ(huffman::inverseMoveToFront(huffman::moveToFront(text)), text);
+
+    const huffman::TransformPipeline pipeline(
+        {huffman::TransformStage::Bwt, huffman::TransformStage::MoveToFront});
+    const std::string transformed = pipeline.forward(text);
+    ASSERT_EQ(transformed.size(), text.size() + 4);
+    ASSERT_EQ(pipeline.inverse(transformed), text);
+
+    // After BWT + MTF most bytes are zero
+    const auto zeros = std::count(transformed.begin(), transformed.end(), '\0');
+    ASSERT_TRUE(static_cast<std::size_t>(zeros) * 2 > text.size());
+}
+
+TEST(test_multi_table_roundtrip) {
+    const huffman::TransformPipeline pipeline(
+        {huffman::TransformStage::Bwt, huffman::TransformStage::MoveToFront});
+    for (std::size_t size : {1u, 49u, 50u, 51u, 7000u, 100000u}) {
+        const std::string transformed = pipeline.forward(wordText(size).substr(0, size));
+        const auto tokens = huffman::zeroRunTokens(transformed);
+        ASSERT_EQ(huffman::expandZeroRuns(tokens, transformed.size()), transformed);
+
+        const auto model = huffman::MultiTableModel::build(tokens, 258);
+        ASSERT_TRUE(model.tables().size() <= huffman::MultiTableModel::kMaxTables);
+        huffman::BitWriter writer;
+        model.encodeTo(writer, tokens);
+        ASSERT_EQ(writer.bitCount(), model.encodedBits());
+        const std::size_t bitCount = writer.bitCount();
+        const std::string bytes = writer.finish();
+        ASSERT_TRUE(huffman::MultiTableDecoder(model).decode(bytes, bitCount, tokens.size()) == tokens);
+    }
+}
+
+TEST(test_bwt_stream_ratio) {
+    const std::string text = wordText(400000);
+    huffman::StreamOptions options;
+    options.blockSize = 150000;
+    options.bwt = true;
+    options.blockIndex = true;
+    const std::string bwtStream = huffman::StreamEncoder(options).encode(text);
+    const std::string plainStream = huffman::StreamEncoder({150000, 0}).encode(text);
+    ASSERT_TRUE(bwtStream.size() * 3 < plainStream.size());
+
+    huffman::StreamDecoder decoder(2);
+    ASSERT_EQ(decoder.decode(bwtStream), text);
+    ASSERT_EQ(decoder.readAt(bwtStream, 140000, 20000), text.substr(140000, 20000));
+
+    ASSERT_THROW((void)huffman::expandZeroRuns({huffman::kRunB, huffman::kRunB}, 5),
+                 std::runtime_error);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== BWT Pipeline Unit Tests ===\n\n";
+
+    RUN_TEST(test_suffix_array_matches_naive);
+    RUN_TEST(test_bwt_roundtrip);
+    RUN_TEST(test_pipeline_stages_compose);
+    RUN_TEST(test_multi_table_roundtrip);
+    RUN_TEST(test_bwt_stream_ratio);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
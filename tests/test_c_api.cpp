@@ -0,0 +1,199 @@
+#include "huffman_c.h"
+#include "test_common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string sampleText(std::size_t size) {
+    const std::string words[] = {"alpha ", "beta ", "gamma ", "delta\n"};
+    std::mt19937 rng(5);
+    std::string text;
+    while (text.size() < size) {
+        text += words[rng() % 4];
+    }
+    text.resize(size);
+    return text;
+}
+
+} // namespace
+
+TEST(test_c_api_roundtrip) {
+    huff_options options;
+    huff_options_init(&options);
+    options.block_size = 4096;
+    options.run_length = 1;
+    huff_context* ctx = huff_context_create(&options);
+    ASSERT_TRUE(ctx != nullptr);
+
+    const std::string input = sampleText(50000);
+    std::string compressed(huff_compress_bound(ctx, input.size()), '\0');
+    size_t compressedSize = 0;
+    ASSERT_EQ(huff_compress(ctx, input.data(), input.size(), compressed.data(), compressed.size(),
+                            &compressedSize),
+              HUFF_OK);
+    ASSERT_TRUE(compressedSize < input.size());
+
+    uint64_t size = 0;
+    ASSERT_EQ(huff_decompressed_size(compressed.data(), compressedSize, &size), HUFF_OK);
+    ASSERT_EQ(size, input.size());
+
+    std::string output(input.size(), '\0');
+    size_t outputSize = 0;
+    ASSERT_EQ(huff_decompress(ctx, compressed.data(), compressedSize, output.data(), output.size(),
+                              &outputSize),
+              HUFF_OK);
+    ASSERT_EQ(outputSize, input.size());
+    ASSERT_EQ(output, input);
+
+    // Empty input round-trips through null pointers
+    ASSERT_EQ(huff_compress(ctx, nullptr, 0, compressed.data(), compressed.size(), &compressedSize),
+              HUFF_OK);
+    ASSERT_EQ(huff_decompress(ctx, compressed.data(), compressedSize, nullptr, 0, &outputSize),
+              HUFF_OK);
+    ASSERT_EQ(outputSize, 0u);
+
+    huff_context_free(ctx);
+}
+
+TEST(test_c_api_stats) {
+    huff_context* ctx = huff_context_create(nullptr);
+    ASSERT_TRUE(ctx != nullptr);
+    const std::string input = sampleText(20000);
+    std::string compressed(huff_compress_bound(ctx, input.size()), '\0');
+    size_t compressedSize = 0;
+    ASSERT_EQ(huff_compress(ctx, input.data(), input.size(), compressed.data(), compressed.size(),
+                            &compressedSize),
+              HUFF_OK);
+
+    huff_stats stats;
+    std::memset(&stats, 0, sizeof(stats));
+    ASSERT_EQ(huff_get_stats(ctx, HUFF_STATS_COMPRESS, &stats), HUFF_ERROR_INVALID_ARGUMENT);
+    stats.struct_size = sizeof(stats);
+    ASSERT_EQ(huff_get_stats(ctx, HUFF_STATS_COMPRESS, &stats), HUFF_OK);
+    if (huff_stats_enabled()) {
+        ASSERT_EQ(stats.bytes_in, input.size());
+        ASSERT_EQ(stats.bytes_out, compressedSize);
+    } else {
+        ASSERT_EQ(stats.bytes_in, 0u);
+    }
+
+    // An older, shorter struct only receives the counters it has room for
+    huff_stats partial;
+    std::memset(&partial, 0xAB, sizeof(partial));
+    partial.struct_size = offsetof(huff_stats, blocks);
+    ASSERT_EQ(huff_get_stats(ctx, HUFF_STATS_COMPRESS, &partial), HUFF_OK);
+    ASSERT_EQ(partial.bytes_out, stats.bytes_out);
+    ASSERT_EQ(partial.blocks, 0xABABABABABABABABu);
+
+    huff_reset_stats(ctx);
+    ASSERT_EQ(huff_get_stats(ctx, HUFF_STATS_COMPRESS, &stats), HUFF_OK);
+    ASSERT_EQ(stats.bytes_in, 0u);
+    ASSERT_EQ(huff_get_stats(ctx, HUFF_STATS_DECOMPRESS, &stats), HUFF_OK);
+    ASSERT_EQ(stats.blocks, 0u);
+
+    huff_context_free(ctx);
+}
+
+TEST(test_c_api_reports_errors) {
+    huff_context* ctx = huff_context_create(nullptr);
+    ASSERT_TRUE(ctx != nullptr);
+
+    const std::string input = sampleText(10000);
+    char small[16];
+    size_t needed = 0;
+    ASSERT_EQ(huff_compress(ctx, input.data(), input.size(), small, sizeof(small), &needed),
+              HUFF_ERROR_DST_TOO_SMALL);
+    ASSERT_TRUE(needed > sizeof(small) && needed <= huff_compress_bound(ctx, input.size()));
+
+    std::string compressed(needed, '\0');
+    ASSERT_EQ(huff_compress(ctx, input.data(), input.size(), compressed.data(), compressed.size(),
+                            &needed),
+              HUFF_OK);
+    // A buffer of the full bound is written directly and gets the same bytes
+    std::string direct(huff_compress_bound(ctx, input.size()), '\0');
+    size_t directSize = 0;
+    ASSERT_EQ(huff_compress(ctx, input.data(), input.size(), direct.data(), direct.size(),
+                            &directSize),
+              HUFF_OK);
+    ASSERT_EQ(directSize, needed);
+    ASSERT_EQ(direct.substr(0, directSize), compressed);
+    size_t outputSize = 0;
+    ASSERT_EQ(huff_decompress(ctx, compressed.data(), compressed.size(), small, sizeof(small),
+                              &outputSize),
+              HUFF_ERROR_DST_TOO_SMALL);
+    ASSERT_EQ(outputSize, input.size());
+
+    std::string corrupt = compressed;
+    corrupt[0] = 'X';
+    std::string output(input.size(), '\0');
+    ASSERT_EQ(huff_decompress(ctx, corrupt.data(), corrupt.size(), output.data(), output.size(),
+                              &outputSize),
+              HUFF_ERROR_CORRUPT_INPUT);
+    ASSERT_TRUE(std::strlen(huff_last_error(ctx)) > 0);
+
+    ASSERT_EQ(huff_compress(ctx, nullptr, 5, small, sizeof(small), &needed),
+              HUFF_ERROR_INVALID_ARGUMENT);
+    ASSERT_TRUE(std::strcmp(huff_status_string(HUFF_ERROR_CORRUPT_INPUT), "corrupt input") == 0);
+    ASSERT_TRUE(std::strlen(huff_version()) > 0);
+    huff_context_free(ctx);
+
+    // Invalid options and structs smaller than any released layout are rejected
+    huff_options options;
+    huff_options_init(&options);
+    options.block_size = 0;
+    ASSERT_TRUE(huff_context_create(&options) == nullptr);
+    huff_options_init(&options);
+    options.struct_size = 8;
+    ASSERT_TRUE(huff_context_create(&options) == nullptr);
+}
+
+TEST(test_c_api_accepts_newer_option_structs) {
+    // A caller built against a later header passes a larger struct
+    struct {
+        huff_options options;
+        std::uint64_t laterFields[4];
+    } newer{};
+    huff_options_init(&newer.options);
+    newer.options.struct_size = sizeof(newer);
+    newer.options.block_size = 1024;
+    huff_context* ctx = huff_context_create(&newer.options);
+    ASSERT_TRUE(ctx != nullptr);
+
+    const std::string input = sampleText(5000);
+    std::string compressed(huff_compress_bound(ctx, input.size()), '\0');
+    size_t compressedSize = 0;
+    ASSERT_EQ(huff_compress(ctx, input.data(), input.size(), compressed.data(), compressed.size(),
+                            &compressedSize),
+              HUFF_OK);
+    std::string output(input.size(), '\0');
+    size_t outputSize = 0;
+    ASSERT_EQ(huff_decompress(ctx, compressed.data(), compressedSize, output.data(),
+                              output.size(), &outputSize),
+              HUFF_OK);
+    ASSERT_EQ(output, input);
+    huff_context_free(ctx);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== C API Unit Tests ===\n\n";
+
+    RUN_TEST(test_c_api_roundtrip);
+    RUN_TEST(test_c_api_reports_errors);
+    RUN_TEST(test_c_api_accepts_newer_option_structs);
+    RUN_TEST(test_c_api_stats);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
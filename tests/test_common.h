@@ -0,0 +1,28 @@
+#ifndef HUFFMAN_TEST_COMMON_H
+#define HUFFMAN_TEST_COMMON_H
+
+#include <iostream>
+#include <stdexcept>
+
+// Simple test framework macros
+#define TEST(name) void name()
+#define ASSERT_TRUE(cond) \
+    do { if (!(cond)) { \
+        std::cerr << "FAILED: " << #cond << " at " << __FILE__ << ":" << __LINE__ << '\n'; \
+        throw std::runtime_error("Test assertion failed"); \
+    }} while(0)
+#define ASSERT_EQ(a, b) ASSERT_TRUE((a) == (b))
+#define ASSERT_THROW(expr, exc_type) \
+    do { bool caught = false; \
+        try { (void)(expr); } catch (const exc_type&) { caught = true; } \
+        if (!caught) { \
+            std::cerr << "FAILED: Expected exception " << #exc_type << " at " << __FILE__ << ":" << __LINE__ << '\n'; \
+            throw std::runtime_error("Expected exception not thrown"); \
+        }} while(0)
+
+#define RUN_TEST(name) \
+    do { std::cout << "Running " << #name << "... "; \
+        try { name(); std::cout << "PASSED\n"; ++passed; } \
+        catch (...) { std::cout << "FAILED\n"; ++failed; }} while(0)
+
+#endif // HUFFMAN_TEST_COMMON_H
@@ -0,0 +1,117 @@
+#include "code_table.h"
+#include "context_model.h"
+#include "stream.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Each letter is usually followed by a fixed partner, so order-1 statistics
+// are much sharper than order-0 ones.
+std::string correlatedText(std::size_t size) {
+    std::mt19937 rng(5);
+    std::string text;
+    char prev = 'a';
+    while (text.size() < size) {
+        const bool partner = rng() % 8 != 0;
+        prev = partner ? static_cast<char>('a' + (prev - 'a' + 7) % 26)
+                       : static_cast<char>('a' + rng() % 26);
+        text.push_back(prev);
+    }
+    return text;
+}
+
+std::string roundtrip(const std::string& input, unsigned maxTables) {
+    const auto model = huffman::ContextModel::build(input, maxTables);
+    huffman::BitWriter writer;
+    model.encodeTo(writer, input);
+    const std::size_t bitCount = writer.bitCount();
+    const std::string bytes = writer.finish();
+
+    std::string out(input.size(), '\0');
+    huffman::ContextDecoder(model).decodeInto(out.data(), out.size(), bytes, bitCount);
+    return out;
+}
+
+} // namespace
+
+TEST(test_context_roundtrip) {
+    ASSERT_EQ(roundtrip("hello world", 4), "hello world");
+    ASSERT_EQ(roundtrip("aaaa", 1), "aaaa");
+    ASSERT_EQ(roundtrip("", 16), "");
+
+    std::string all;
+    for (int i = 0; i < 256; ++i) all.push_back(static_cast<char>(i));
+    ASSERT_EQ(roundtrip(all + all, 256), all + all);
+
+    const std::string text = correlatedText(20000);
+    for (unsigned tables : {1u, 3u, 16u, 256u}) {
+        ASSERT_EQ(roundtrip(text, tables), text);
+    }
+}
+
+TEST(test_context_beats_order0_on_correlated_text) {
+    const std::string text = correlatedText(100000);
+    const auto model = huffman::ContextModel::build(text, 16);
+    ASSERT_TRUE(model.tables().size() <= 16);
+
+    const auto order0 = huffman::CodeTable::fromFrequencies(
+        [&] {
+            std::vector<std::uint64_t> freq(256, 0);
+            for (char ch : text) ++freq[static_cast<unsigned char>(ch)];
+            return freq;
+        }());
+    ASSERT_TRUE(model.encodedBits() * 2 < order0.encode(text).bitCount);
+}
+
+TEST(test_context_invalid_arguments_throw) {
+    ASSERT_THROW(huffman::ContextModel::build("abc", 0), std::invalid_argument);
+    ASSERT_THROW(huffman::ContextModel::build("abc", 257), std::invalid_argument);
+
+    std::array<std::uint8_t, 256> tableOf{};
+    tableOf[7] = 1;
+    std::vector<huffman::CodeTable> tables{huffman::CodeTable(std::vector<std::uint8_t>(256, 8))};
+    ASSERT_THROW(huffman::ContextModel(tableOf, tables), std::invalid_argument);
+}
+
+TEST(test_context_stream_blocks) {
+    const std::string text = correlatedText(150000);
+    huffman::StreamOptions options;
+    options.blockSize = 65536;
+    options.contextTables = 8;
+    options.blockIndex = true;
+    const std::string contextStream = huffman::StreamEncoder(options).encode(text);
+    const std::string plainStream = huffman::StreamEncoder({65536, 0}).encode(text);
+    ASSERT_TRUE(contextStream.size() < plainStream.size());
+
+    huffman::StreamDecoder decoder(3);
+    ASSERT_EQ(decoder.decode(contextStream), text);
+    ASSERT_EQ(decoder.readAt(contextStream, 70000, 1000), text.substr(70000, 1000));
+
+    // Uncorrelated blocks keep the single-table encoding
+    options.contextTables = 256;
+    ASSERT_EQ(decoder.decode(huffman::StreamEncoder(options).encode("hello world")),
+              "hello world");
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Context Model Unit Tests ===\n\n";
+
+    RUN_TEST(test_context_roundtrip);
+    RUN_TEST(test_context_beats_order0_on_correlated_text);
+    RUN_TEST(test_context_invalid_arguments_throw);
+    RUN_TEST(test_context_stream_blocks);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
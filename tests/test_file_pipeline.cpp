@@ -0,0 +1,186 @@
+#include "file_pipeline.h"
+#include "test_common.h"
+
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::atomic<bool> delayWrites{false};
+std::atomic<unsigned> writeCalls{0};
+
+} // namespace
+
+// Replaces libc's pwrite for this binary, which links the library
+// statically, so a test can hold every other write back and make the
+// ThreadFileIo backend complete writes out of order.
+extern "C" ssize_t pwrite(int fd, const void* buffer, std::size_t size, off_t offset) {
+    if (delayWrites && writeCalls.fetch_add(1) % 2 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    }
+    return static_cast<ssize_t>(::syscall(SYS_pwrite64, fd, buffer, size, offset));
+}
+
+namespace {
+
+std::string tempPath(const std::string& name) {
+    return "/tmp/huffman_file_pipeline_" + std::to_string(::getpid()) + "_" + name;
+}
+
+void writeFile(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::string sampleText(std::size_t size, unsigned seed) {
+    static const char* const words[] = {"the ", "quick ", "brown ", "fox ", "jumps ",
+                                        "over ", "lazy ", "dog ", "\n"};
+    std::mt19937 rng(seed);
+    std::string text;
+    while (text.size() < size) {
+        text += words[rng() % 9];
+    }
+    text.resize(size);
+    return text;
+}
+
+// Compresses `data` through a temp file and checks the stream decodes back
+void checkRoundTrip(const std::string& data, const huffman::FileCompressOptions& options) {
+    const std::string input = tempPath("in");
+    const std::string output = tempPath("out");
+    writeFile(input, data);
+    const huffman::FileCompressResult result = huffman::compressFile(input, output, options);
+    const std::string stream = readFile(output);
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+
+    ASSERT_EQ(result.bytesIn, data.size());
+    ASSERT_EQ(result.bytesOut, stream.size());
+    ASSERT_TRUE(huffman::StreamDecoder(2).decode(stream) == data);
+}
+
+} // namespace
+
+TEST(test_file_pipeline_threads_roundtrip) {
+    huffman::FileCompressOptions options;
+    options.backend = huffman::IoBackend::Threads;
+    options.stream.blockSize = 4096;
+    options.queueDepth = 3;
+    options.threads = 2;
+    checkRoundTrip(sampleText(100000, 1), options);
+    // Exactly one block, and a size that is a multiple of the block size
+    checkRoundTrip(sampleText(4096, 2), options);
+    checkRoundTrip(sampleText(3 * 4096, 3), options);
+}
+
+TEST(test_file_pipeline_io_uring_roundtrip) {
+    if (!huffman::isIoUringAvailable()) {
+        std::cout << "(io_uring unavailable, skipped) ";
+        return;
+    }
+    huffman::FileCompressOptions options;
+    options.backend = huffman::IoBackend::IoUring;
+    options.stream.blockSize = 8192;
+    options.queueDepth = 4;
+    checkRoundTrip(sampleText(200000, 4), options);
+
+    const std::string input = tempPath("in");
+    const std::string output = tempPath("out");
+    writeFile(input, "abc");
+    const auto result = huffman::compressFile(input, output, options);
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    ASSERT_TRUE(result.backend == huffman::IoBackend::IoUring);
+}
+
+TEST(test_file_pipeline_out_of_order_writes) {
+    // Later blocks' writes finish first; no slot may be refilled while an
+    // earlier write still reads from it
+    huffman::FileCompressOptions options;
+    options.backend = huffman::IoBackend::Threads;
+    options.stream.blockSize = 4096;
+    options.queueDepth = 8;
+    delayWrites = true;
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        checkRoundTrip(sampleText(200000, 10 + seed), options);
+    }
+    delayWrites = false;
+}
+
+TEST(test_file_pipeline_empty_and_index) {
+    huffman::FileCompressOptions options;
+    checkRoundTrip(std::string(), options);
+
+    options.stream.blockSize = 1024;
+    options.stream.blockIndex = true;
+    const std::string data = sampleText(50000, 5);
+    const std::string input = tempPath("in");
+    const std::string output = tempPath("out");
+    writeFile(input, data);
+    static_cast<void>(huffman::compressFile(input, output, options));
+    const std::string stream = readFile(output);
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+
+    const huffman::StreamDecoder decoder(1);
+    ASSERT_TRUE(decoder.decode(stream) == data);
+    ASSERT_TRUE(decoder.readAt(stream, 30000, 2500) == data.substr(30000, 2500));
+}
+
+TEST(test_file_pipeline_errors) {
+    huffman::FileCompressOptions options;
+    ASSERT_THROW(static_cast<void>(huffman::compressFile(tempPath("missing"), tempPath("out"),
+                                                         options)),
+                 std::runtime_error);
+
+    // A directory opens but fails on the first read; no output is left behind
+    const std::string directory = tempPath("dir");
+    const std::string output = tempPath("dir_out");
+    ASSERT_TRUE(::mkdir(directory.c_str(), 0755) == 0);
+    options.backend = huffman::IoBackend::Threads;
+    ASSERT_THROW(static_cast<void>(huffman::compressFile(directory, output, options)),
+                 std::runtime_error);
+    ::rmdir(directory.c_str());
+    ASSERT_TRUE(::access(output.c_str(), F_OK) != 0);
+
+    options.queueDepth = 0;
+    ASSERT_THROW(static_cast<void>(huffman::compressFile(tempPath("missing"), tempPath("out"),
+                                                         options)),
+                 std::invalid_argument);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== File Pipeline Unit Tests ===\n\n";
+
+    RUN_TEST(test_file_pipeline_threads_roundtrip);
+    RUN_TEST(test_file_pipeline_io_uring_roundtrip);
+    RUN_TEST(test_file_pipeline_out_of_order_writes);
+    RUN_TEST(test_file_pipeline_empty_and_index);
+    RUN_TEST(test_file_pipeline_errors);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
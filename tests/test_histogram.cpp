@@ -0,0 +1,133 @@
+#include "code_table.h"
+#include "histogram.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+huffman::Histogram naiveHistogram(const std::string& data) {
+    huffman::Histogram h{};
+    for (char ch : data) {
+        ++h[static_cast<unsigned char>(ch)];
+    }
+    return h;
+}
+
+const huffman::HistogramKernel kAllKernels[] = {
+    huffman::HistogramKernel::Scalar,
+    huffman::HistogramKernel::Sse4,
+    huffman::HistogramKernel::Avx2,
+};
+
+} // namespace
+
+TEST(test_kernels_match_naive_count) {
+    std::mt19937 rng(42);
+    std::string data(100003, '\0');
+    for (auto& ch : data) {
+        ch = static_cast<char>(rng() % 7 == 0 ? rng() : 'e');
+    }
+    const auto expected = naiveHistogram(data);
+
+    for (auto kernel : kAllKernels) {
+        if (!huffman::isKernelSupported(kernel)) continue;
+        ASSERT_TRUE(huffman::computeHistogram(data, kernel) == expected);
+    }
+}
+
+TEST(test_kernels_handle_runs_and_tails) {
+    std::string data(1000, 'a');
+    data += "bcd";
+    const auto expected = naiveHistogram(data);
+
+    for (auto kernel : kAllKernels) {
+        if (!huffman::isKernelSupported(kernel)) continue;
+        for (std::size_t len : {0u, 1u, 15u, 16u, 33u, 1003u}) {
+            ASSERT_TRUE(huffman::computeHistogram(data.substr(0, len), kernel) ==
+                        naiveHistogram(data.substr(0, len)));
+        }
+        ASSERT_TRUE(huffman::computeHistogram(data, kernel) == expected);
+    }
+}
+
+TEST(test_parallel_matches_serial) {
+    std::mt19937 rng(7);
+    std::string data(3 * huffman::kParallelHistogramMinSlice + 12345, '\0');
+    for (auto& ch : data) {
+        ch = static_cast<char>(rng() % 200);
+    }
+    const auto expected = naiveHistogram(data);
+
+    for (unsigned threads : {0u, 1u, 2u, 3u, 8u}) {
+        ASSERT_TRUE(huffman::computeHistogramParallel(data, threads) == expected);
+    }
+    ASSERT_TRUE(huffman::computeHistogramParallel("", 4) == huffman::Histogram{});
+}
+
+TEST(test_dispatch_selects_supported_kernel) {
+    ASSERT_TRUE(huffman::isKernelSupported(huffman::detectHistogramKernel()));
+    ASSERT_TRUE(huffman::isKernelSupported(huffman::HistogramKernel::Scalar));
+}
+
+TEST(test_estimate_matches_encoded_size) {
+    std::mt19937 rng(13);
+    std::string text;
+    while (text.size() < 300000) {
+        text.append(1 + rng() % 6, static_cast<char>('a' + std::min<unsigned>(static_cast<unsigned>(rng() % 40), 25u)));
+        text.push_back(' ');
+    }
+    const huffman::Histogram histogram = naiveHistogram(text);
+    const auto table = huffman::CodeTable::fromFrequencies(
+        std::vector<std::uint64_t>(histogram.begin(), histogram.end()));
+    const std::uint64_t encoded = 256 + table.encode(text).bytes.size();
+    ASSERT_EQ(huffman::estimateCompressedSize(histogram), encoded);
+
+    // Entropy is a lower bound within a fraction of a bit of Huffman
+    const double entropyBytes = huffman::entropyBitsPerByte(histogram) * static_cast<double>(text.size()) / 8;
+    ASSERT_TRUE(entropyBytes <= static_cast<double>(encoded - 256));
+    ASSERT_TRUE(entropyBytes > 0.95 * static_cast<double>(encoded - 256));
+
+    // The sampled estimate lands within a few percent
+    const double sampled = static_cast<double>(huffman::estimateCompressedSize(text, 32768));
+    ASSERT_TRUE(sampled > 0.97 * static_cast<double>(encoded));
+    ASSERT_TRUE(sampled < 1.03 * static_cast<double>(encoded));
+}
+
+TEST(test_estimate_flags_incompressible_input) {
+    std::mt19937 rng(14);
+    std::string random(500000, '\0');
+    for (auto& ch : random) ch = static_cast<char>(rng());
+    ASSERT_TRUE(huffman::estimateCompressedSize(random) >= random.size());
+    ASSERT_TRUE(huffman::entropyBitsPerByte(huffman::sampleHistogram(random)) > 7.9);
+
+    ASSERT_EQ(huffman::estimateCompressedSize(std::string_view()), std::uint64_t{256});
+    ASSERT_EQ(huffman::entropyBitsPerByte(huffman::Histogram{}), 0.0);
+
+    // Small inputs are counted in full
+    const std::string small = "abracadabra";
+    ASSERT_TRUE(huffman::sampleHistogram(small) == naiveHistogram(small));
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Histogram Unit Tests ===\n\n";
+
+    RUN_TEST(test_kernels_match_naive_count);
+    RUN_TEST(test_kernels_handle_runs_and_tails);
+    RUN_TEST(test_parallel_matches_serial);
+    RUN_TEST(test_dispatch_selects_supported_kernel);
+    RUN_TEST(test_estimate_matches_encoded_size);
+    RUN_TEST(test_estimate_flags_incompressible_input);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
@@ -1,30 +1,15 @@
 #include "huffman.h"
+#include "test_common.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
-
-// Simple test framework macros
-#define TEST(name) void name()
-#define ASSERT_TRUE(cond) \
-    do { if (!(cond)) { \
-        std::cerr << "FAILED: " << #cond << " at " << __FILE__ << ":" << __LINE__ << '\n'; \
-        throw std::runtime_error("Test assertion failed"); \
-    }} while(0)
-#define ASSERT_EQ(a, b) ASSERT_TRUE((a) == (b))
-#define ASSERT_THROW(expr, exc_type) \
-    do { bool caught = false; \
-        try { (void)(expr); } catch (const exc_type&) { caught = true; } \
-        if (!caught) { \
-            std::cerr << "FAILED: Expected exception " << #exc_type << " at " << __FILE__ << ":" << __LINE__ << '\n'; \
-            throw std::runtime_error("Expected exception not thrown"); \
-        }} while(0)
-
-#define RUN_TEST(name) \
-    do { std::cout << "Running " << #name << "... "; \
-        try { name(); std::cout << "PASSED\n"; ++passed; } \
-        catch (...) { std::cout << "FAILED\n"; ++failed; }} while(0)
+#include <vector>
 
 TEST(test_basic_encode_decode) {
     huffman::HuffmanTree tree;
@@ -124,12 +109,18 @@ TEST(test_codes_are_prefix_free) {
     std::string input = "abcdefghij";
     tree.buildTree(input);
 
-    const auto& codes = tree.getCodes();
+    std::vector<std::string> codes;
+    for (const huffman::TreeCode& code : tree.getCodes()) {
+        if (code.length != 0) codes.push_back(code.toString());
+    }
+    ASSERT_EQ(codes.size(), 10u);
 
     // Verify no code is a prefix of another
-    for (const auto& [ch1, code1] : codes) {
-        for (const auto& [ch2, code2] : codes) {
-            if (ch1 != ch2) {
+    for (std::size_t i = 0; i < codes.size(); ++i) {
+        for (std::size_t j = 0; j < codes.size(); ++j) {
+            const std::string& code1 = codes[i];
+            const std::string& code2 = codes[j];
+            if (i != j) {
                 ASSERT_TRUE(code1.find(code2) != 0 || code1.size() <= code2.size());
                 ASSERT_TRUE(code2.find(code1) != 0 || code2.size() <= code1.size());
             }
@@ -137,6 +128,20 @@ TEST(test_codes_are_prefix_free) {
     }
 }
 
+TEST(test_codes_are_dense_array) {
+    huffman::HuffmanTree tree;
+    tree.buildTree("aaaabbc");
+
+    const huffman::CodeArray& codes = tree.getCodes();
+    ASSERT_EQ(codes['a'].length, 1u);
+    ASSERT_EQ(codes['b'].length, 2u);
+    ASSERT_EQ(codes['c'].length, 2u);
+    ASSERT_EQ(codes['d'].length, 0u);
+    for (char ch : std::string("abc")) {
+        ASSERT_EQ(codes[static_cast<unsigned char>(ch)].toString(), tree.encode(std::string(1, ch)));
+    }
+}
+
 TEST(test_frequencies) {
     huffman::HuffmanTree tree;
     std::string input = "aaabbc";
@@ -144,9 +149,9 @@ TEST(test_frequencies) {
 
     const auto& freqs = tree.getFrequencies();
 
-    ASSERT_EQ(freqs.at('a'), 3);
-    ASSERT_EQ(freqs.at('b'), 2);
-    ASSERT_EQ(freqs.at('c'), 1);
+    ASSERT_EQ(freqs.at('a'), 3u);
+    ASSERT_EQ(freqs.at('b'), 2u);
+    ASSERT_EQ(freqs.at('c'), 1u);
 }
 
 TEST(test_empty_input_throws) {
@@ -205,6 +210,160 @@ TEST(test_rebuild_tree) {
     ASSERT_EQ(decoded2, "xyz");
 }
 
+namespace {
+
+// Counts allocations passed through to the default resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    int allocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        ++allocations;
+        return std::pmr::get_default_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        std::pmr::get_default_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+TEST(test_rebuild_reuses_node_storage) {
+    CountingResource resource;
+    huffman::HuffmanTree tree(&resource);
+
+    std::string all;
+    for (int i = 0; i < 256; ++i) all.push_back(static_cast<char>(i));
+    for (int i = 0; i < 1000; ++i) {
+        const std::string input = i % 2 == 0 ? all + "abc" : "xyzzy" + std::to_string(i);
+        tree.buildTree(input);
+        ASSERT_EQ(tree.decode(tree.encode(input)), input);
+    }
+    ASSERT_EQ(resource.allocations, 1);
+
+    // Moved and copied trees keep working: nodes link by index
+    huffman::HuffmanTree moved = std::move(tree);
+    ASSERT_EQ(moved.decode(moved.encode("xyzzy999")), "xyzzy999");
+    huffman::HuffmanTree copy = moved;
+    ASSERT_EQ(copy.decode(copy.encode("xyzzy999")), "xyzzy999");
+}
+
+TEST(test_degenerate_tree_deep_codes) {
+    // Fibonacci frequencies give a maximally unbalanced tree
+    std::string input;
+    int a = 1;
+    int b = 1;
+    const int symbols = 26;
+    for (int i = 0; i < symbols; ++i) {
+        input.append(static_cast<std::size_t>(a), static_cast<char>('a' + i));
+        const int next = a + b;
+        a = b;
+        b = next;
+    }
+
+    huffman::HuffmanTree tree;
+    tree.buildTree(input);
+
+    std::size_t longest = 0;
+    for (const huffman::TreeCode& code : tree.getCodes()) {
+        longest = std::max<std::size_t>(longest, code.length);
+    }
+    ASSERT_EQ(longest, static_cast<std::size_t>(symbols - 1));
+    ASSERT_EQ(tree.decode(tree.encode(input)), input);
+}
+
+TEST(test_wide_symbol_trees) {
+    // Tokenizer-style IDs with a skewed distribution over a 16-bit alphabet
+    std::vector<std::uint16_t> tokens;
+    for (std::uint16_t i = 0; i < 5000; ++i) {
+        tokens.push_back(static_cast<std::uint16_t>(i % 7 == 0 ? 60000 + i % 3 : i % 40));
+    }
+    huffman::HuffmanTree16 tree16;
+    tree16.buildTree(tokens);
+    ASSERT_EQ(tree16.decode(tree16.encode(tokens)), tokens);
+    ASSERT_EQ(tree16.getCodes().size(), std::size_t{1} << 16);
+    ASSERT_TRUE(tree16.findCode(60001) != nullptr);
+    ASSERT_TRUE(tree16.findCode(12345) == nullptr);
+
+    // Sparse values over a 32-bit alphabet
+    std::vector<std::uint32_t> values;
+    for (std::uint32_t i = 0; i < 3000; ++i) {
+        values.push_back(0xF0000000u + (i * i) % 97);
+    }
+    huffman::HuffmanTree32 tree32;
+    tree32.buildTree(values);
+    ASSERT_EQ(tree32.decode(tree32.encode(values)), values);
+    ASSERT_EQ(tree32.getCodes().size(), tree32.getFrequencies().size());
+
+    const std::vector<std::uint32_t> unknown = {7};
+    ASSERT_THROW(static_cast<void>(tree32.encode(unknown)), std::runtime_error);
+
+    // Custom alphabets reject symbols outside [0, MaxSymbols)
+    huffman::BasicHuffmanTree<std::uint16_t, 1000> lengths;
+    lengths.buildTree(std::vector<std::uint16_t>{999, 999, 1});
+    ASSERT_EQ(lengths.findCode(999)->length, 1u);
+    ASSERT_THROW(lengths.buildTree(std::vector<std::uint16_t>{1000}), std::invalid_argument);
+    ASSERT_EQ(lengths.findCode(1)->length, 1u);
+}
+
+TEST(test_build_from_histogram) {
+    const std::string text = "abracadabra, the quick brown fox";
+    huffman::HuffmanTree fromText;
+    fromText.buildTree(text);
+    huffman::HuffmanTree fromCounts;
+    fromCounts.buildTree(huffman::computeHistogram(text));
+
+    const auto& expected = fromText.getCodes();
+    const auto& actual = fromCounts.getCodes();
+    for (std::size_t b = 0; b < expected.size(); ++b) {
+        ASSERT_EQ(actual[b].length, expected[b].length);
+        ASSERT_EQ(actual[b].bits, expected[b].bits);
+    }
+    ASSERT_EQ(fromCounts.decode(fromCounts.encode(text)), text);
+    ASSERT_THROW(fromCounts.buildTree(huffman::Histogram{}), std::invalid_argument);
+}
+
+TEST(test_counts_beyond_32_bits) {
+    // Counts of a multi-gigabyte input are kept exactly
+    huffman::Histogram counts{};
+    counts['a'] = 3'000'000'000u;
+    counts['b'] = 5'000'000'000u;
+    counts['c'] = 7;
+    huffman::HuffmanTree tree;
+    tree.buildTree(counts);
+    ASSERT_EQ(tree.getFrequencies().at('b'), 5'000'000'000u);
+    ASSERT_EQ(tree.findCode('b')->length, 1u);
+    ASSERT_EQ(tree.findCode('c')->length, 2u);
+
+    // Fibonacci counts this large would need codes longer than 64 bits
+    huffman::Histogram fibonacci{};
+    std::uint64_t previous = 1;
+    std::uint64_t current = 1;
+    for (std::size_t b = 0; b < 70; ++b) {
+        fibonacci[b] = current;
+        const std::uint64_t next = previous + current;
+        previous = current;
+        current = next;
+    }
+    ASSERT_THROW(tree.buildTree(fibonacci), std::runtime_error);
+    // The failed build leaves no tree or partial codes behind
+    ASSERT_TRUE(!tree.isBuilt());
+    for (std::size_t b = 0; b < 70; ++b) {
+        ASSERT_TRUE(tree.findCode(static_cast<char>(b)) == nullptr);
+    }
+    ASSERT_TRUE(tree.getFrequencies().empty());
+    ASSERT_THROW(static_cast<void>(tree.encode("ab")), std::runtime_error);
+
+    huffman::Histogram overflowing{};
+    overflowing['x'] = std::numeric_limits<std::uint64_t>::max();
+    overflowing['y'] = 1;
+    ASSERT_THROW(tree.buildTree(overflowing), std::invalid_argument);
+}
+
 int main() {
     int passed = 0;
     int failed = 0;
@@ -220,6 +379,7 @@ int main() {
     RUN_TEST(test_special_characters);
     RUN_TEST(test_compression_ratio);
     RUN_TEST(test_codes_are_prefix_free);
+    RUN_TEST(test_codes_are_dense_array);
     RUN_TEST(test_frequencies);
     RUN_TEST(test_empty_input_throws);
     RUN_TEST(test_encode_before_build_throws);
@@ -228,6 +388,11 @@ int main() {
     RUN_TEST(test_decode_incomplete_sequence_throws);
     RUN_TEST(test_is_built);
     RUN_TEST(test_rebuild_tree);
+    RUN_TEST(test_rebuild_reuses_node_storage);
+    RUN_TEST(test_degenerate_tree_deep_codes);
+    RUN_TEST(test_wide_symbol_trees);
+    RUN_TEST(test_build_from_histogram);
+    RUN_TEST(test_counts_beyond_32_bits);
 
     std::cout << "\n=== Results ===\n";
     std::cout << "Passed: " << passed << '\n';
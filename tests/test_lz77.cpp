@@ -0,0 +1,122 @@
+#include "lz77.h"
+#include "stream.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Log lines with repeated keys and a few varying fields
+std::string jsonLogs(std::size_t size) {
+    std::mt19937 rng(9);
+    const char* levels[] = {"info", "warn", "error", "debug"};
+    const char* paths[] = {"/api/users", "/api/orders", "/health", "/api/items/search"};
+    std::string text;
+    while (text.size() < size) {
+        text += "{\"ts\":" + std::to_string(1700000000 + rng() % 100000) + ",\"level\":\"" +
+                levels[rng() % 4] + "\",\"path\":\"" + paths[rng() % 4] +
+                "\",\"status\":" + std::to_string(200 + (rng() % 3) * 100) +
+                ",\"latency_ms\":" + std::to_string(rng() % 500) + "}\n";
+    }
+    return text;
+}
+
+std::string roundtrip(const std::string& input, const huffman::Lz77Options& options = {}) {
+    const auto tokens = huffman::parseLz77(input, options);
+    const auto model = huffman::Lz77Model::build(tokens);
+    huffman::BitWriter writer;
+    model.encodeTo(writer, tokens);
+    const std::size_t bitCount = writer.bitCount();
+    const std::string bytes = writer.finish();
+
+    std::string out(input.size(), '\0');
+    huffman::Lz77Decoder(model).decodeInto(out.data(), out.size(), bytes, bitCount);
+    return out;
+}
+
+} // namespace
+
+TEST(test_lz77_roundtrip) {
+    ASSERT_EQ(roundtrip(""), "");
+    ASSERT_EQ(roundtrip("a"), "a");
+    ASSERT_EQ(roundtrip("abcabcabcabcabcabcx"), "abcabcabcabcabcabcx");
+    ASSERT_EQ(roundtrip(std::string(100000, 'z')), std::string(100000, 'z'));
+
+    std::string binary;
+    std::mt19937 rng(2);
+    for (int i = 0; i < 30000; ++i) binary.push_back(static_cast<char>(rng() % 7));
+    const std::string logs = jsonLogs(60000);
+    for (unsigned level : {1u, 4u, 9u}) {
+        for (unsigned windowBits : {8u, 15u, 24u}) {
+            ASSERT_EQ(roundtrip(binary, {windowBits, level}), binary);
+            ASSERT_EQ(roundtrip(logs, {windowBits, level}), logs);
+        }
+    }
+}
+
+TEST(test_lz77_matches_respect_window) {
+    const std::string logs = jsonLogs(20000);
+    for (const auto& token : huffman::parseLz77(logs, {8, 9})) {
+        if (token.distance == 0) continue;
+        ASSERT_TRUE(token.distance <= 256);
+        ASSERT_TRUE(token.length >= huffman::kLz77MinMatch);
+        ASSERT_TRUE(token.length <= huffman::kLz77MaxMatch);
+    }
+}
+
+TEST(test_lz77_stream_beats_order0_on_logs) {
+    const std::string logs = jsonLogs(300000);
+    huffman::StreamOptions options;
+    options.blockSize = 128 * 1024;
+    options.lz77Level = 6;
+    options.blockIndex = true;
+    const std::string lzStream = huffman::StreamEncoder(options).encode(logs);
+    const std::string plainStream = huffman::StreamEncoder({128 * 1024, 0}).encode(logs);
+    ASSERT_TRUE(lzStream.size() * 2 < plainStream.size());
+
+    huffman::StreamDecoder decoder(2);
+    ASSERT_EQ(decoder.decode(lzStream), logs);
+    ASSERT_EQ(decoder.readAt(lzStream, 200000, 5000), logs.substr(200000, 5000));
+}
+
+TEST(test_lz77_invalid_input_throws) {
+    ASSERT_THROW(huffman::parseLz77("abc", {7, 6}), std::invalid_argument);
+    ASSERT_THROW(huffman::parseLz77("abc", {15, 0}), std::invalid_argument);
+    ASSERT_THROW(huffman::parseLz77("abc", {15, 10}), std::invalid_argument);
+
+    huffman::StreamOptions options;
+    options.lz77Level = 10;
+    ASSERT_THROW(huffman::StreamEncoder{options}, std::invalid_argument);
+
+    // A match reaching before the start of the output is rejected
+    std::vector<huffman::Lz77Token> tokens{{'a', 0}, {5, 2}};
+    const auto model = huffman::Lz77Model::build(tokens);
+    huffman::BitWriter writer;
+    model.encodeTo(writer, tokens);
+    const std::size_t bitCount = writer.bitCount();
+    const std::string bytes = writer.finish();
+    std::string out(6, '\0');
+    ASSERT_THROW(huffman::Lz77Decoder(model).decodeInto(out.data(), out.size(), bytes, bitCount),
+                 std::runtime_error);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== LZ77 Unit Tests ===\n\n";
+
+    RUN_TEST(test_lz77_roundtrip);
+    RUN_TEST(test_lz77_matches_respect_window);
+    RUN_TEST(test_lz77_stream_beats_order0_on_logs);
+    RUN_TEST(test_lz77_invalid_input_throws);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include "run_length.h"
+#include "stream.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::string roundtrip(const std::string& input, std::size_t* bits = nullptr) {
+    const auto tokens = huffman::runLengthTokens(input);
+    const auto model = huffman::RunLengthModel::build(tokens);
+    huffman::BitWriter writer;
+    model.encodeTo(writer, tokens);
+    const std::size_t bitCount = writer.bitCount();
+    const std::string bytes = writer.finish();
+    if (bits) *bits = bitCount;
+
+    std::string out(input.size(), '\0');
+    huffman::RunLengthDecoder(model).decodeInto(out.data(), out.size(), bytes, bitCount);
+    return out;
+}
+
+// Fixed-size records, mostly zero padding
+std::string paddedRecords(std::size_t count) {
+    std::mt19937 rng(4);
+    std::string data;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string record(128, '\0');
+        for (int j = 0; j < 6; ++j) record[static_cast<std::size_t>(j)] = static_cast<char>('A' + rng() % 26);
+        data += record;
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(test_run_tokens_are_bijective_base2) {
+    for (std::size_t count = 1; count < 2000; ++count) {
+        std::vector<std::uint16_t> tokens;
+        huffman::appendRunTokens(tokens, count);
+        std::size_t value = 0;
+        std::size_t weight = 1;
+        for (auto token : tokens) {
+            value += (token == huffman::kRunA ? 1 : 2) * weight;
+            weight *= 2;
+        }
+        ASSERT_EQ(value, count);
+    }
+}
+
+TEST(test_run_length_roundtrip) {
+    ASSERT_EQ(roundtrip(""), "");
+    ASSERT_EQ(roundtrip("a"), "a");
+    ASSERT_EQ(roundtrip(std::string(5, '\0')), std::string(5, '\0'));
+    ASSERT_EQ(roundtrip("aaabccccccccd"), "aaabccccccccd");
+
+    std::mt19937 rng(8);
+    std::string mixed;
+    while (mixed.size() < 50000) {
+        mixed.append(rng() % 40, static_cast<char>(rng() % 4));
+    }
+    ASSERT_EQ(roundtrip(mixed), mixed);
+
+    const std::string records = paddedRecords(500);
+    ASSERT_EQ(roundtrip(records), records);
+}
+
+TEST(test_run_length_single_byte_far_below_one_bit) {
+    const std::string input(1 << 20, 'a');
+    std::size_t bits = 0;
+    ASSERT_EQ(roundtrip(input, &bits), input);
+    ASSERT_TRUE(bits < 64);
+
+    huffman::StreamOptions options;
+    options.runLength = true;
+    const std::string stream = huffman::StreamEncoder(options).encode(input);
+    ASSERT_TRUE(stream.size() < 400);
+    ASSERT_EQ(huffman::StreamDecoder().decode(stream), input);
+}
+
+TEST(test_run_length_stream_padded_records) {
+    const std::string records = paddedRecords(4000);
+    huffman::StreamOptions options;
+    options.blockSize = 100000;
+    options.runLength = true;
+    options.blockIndex = true;
+    const std::string stream = huffman::StreamEncoder(options).encode(records);
+    ASSERT_TRUE(stream.size() * 8 < records.size());
+
+    huffman::StreamDecoder decoder(2);
+    ASSERT_EQ(decoder.decode(stream), records);
+    ASSERT_EQ(decoder.readAt(stream, 250000, 3000), records.substr(250000, 3000));
+}
+
+TEST(test_run_length_overlong_run_throws) {
+    const std::vector<std::uint16_t> tokens{'x', huffman::kRunB, huffman::kRunB};
+    const auto model = huffman::RunLengthModel::build(tokens);
+    huffman::BitWriter writer;
+    model.encodeTo(writer, tokens);
+    const std::size_t bitCount = writer.bitCount();
+    const std::string bytes = writer.finish();
+
+    std::string out(4, '\0');
+    ASSERT_THROW(huffman::RunLengthDecoder(model).decodeInto(out.data(), out.size(), bytes, bitCount),
+                 std::runtime_error);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Run-Length Unit Tests ===\n\n";
+
+    RUN_TEST(test_run_tokens_are_bijective_base2);
+    RUN_TEST(test_run_length_roundtrip);
+    RUN_TEST(test_run_length_single_byte_far_below_one_bit);
+    RUN_TEST(test_run_length_stream_padded_records);
+    RUN_TEST(test_run_length_overlong_run_throws);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
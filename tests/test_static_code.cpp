@@ -0,0 +1,112 @@
+#include "static_code.h"
+#include "table_decoder.h"
+#include "test_common.h"
+
+#include <array>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr std::array<std::uint8_t, 4> kSmallLengths = {1, 2, 3, 3};
+constexpr huffman::StaticCodeTable<4, 3> kSmallCode{kSmallLengths};
+
+// Tables are built during constant evaluation
+static_assert(kSmallCode.code(0).bits == 0b0 && kSmallCode.code(0).length == 1);
+static_assert(kSmallCode.code(1).bits == 0b10);
+static_assert(kSmallCode.code(3).bits == 0b111 && kSmallCode.code(3).length == 3);
+static_assert(huffman::kHeaderTextCode.code('e').length == 6);
+static_assert(huffman::kHeaderTextCode.code(0xFF).length == 10);
+
+const std::string kHeaders =
+    "GET /index.html HTTP/1.1\r\nhost: www.example.com\r\n"
+    "user-agent: curl/8.4.0\r\naccept: */*\r\n"
+    "cookie: session=9f8e7d6c; theme=dark\r\ncontent-type: text/html; charset=utf-8\r\n"
+    "x-forwarded-for: 203.0.113.7\r\nvia: caf\xC3\xA9\r\n\r\n";
+
+} // namespace
+
+TEST(test_static_code_matches_runtime_code_table) {
+    const huffman::CodeTable runtime = huffman::kHeaderTextCode.toCodeTable();
+    for (std::size_t sym = 0; sym < 256; ++sym) {
+        ASSERT_EQ(huffman::kHeaderTextCode.code(sym).bits, runtime.code(sym).bits);
+        ASSERT_EQ(huffman::kHeaderTextCode.code(sym).length, runtime.code(sym).length);
+    }
+
+    const auto packed = huffman::kHeaderTextCode.encode(kHeaders);
+    const auto expected = runtime.encode(kHeaders);
+    ASSERT_EQ(packed.bytes, expected.bytes);
+    ASSERT_EQ(packed.bitCount, expected.bitCount);
+    ASSERT_EQ(huffman::TableDecoder(runtime).decode(packed), kHeaders);
+}
+
+TEST(test_static_code_roundtrip) {
+    ASSERT_EQ(huffman::kHeaderTextCode.decode(huffman::kHeaderTextCode.encode(kHeaders)), kHeaders);
+    ASSERT_TRUE(huffman::kHeaderTextCode.encode(kHeaders).bitCount < kHeaders.size() * 7);
+
+    std::string all;
+    for (int i = 0; i < 256; ++i) all.push_back(static_cast<char>(i));
+    ASSERT_EQ(huffman::kHeaderTextCode.decode(huffman::kHeaderTextCode.encode(all + all)), all + all);
+    ASSERT_EQ(huffman::kHeaderTextCode.decode(huffman::kHeaderTextCode.encode("")), "");
+}
+
+TEST(test_static_code_small_alphabet) {
+    huffman::BitWriter writer;
+    for (std::size_t sym : {3u, 0u, 1u, 2u, 0u}) kSmallCode.writeSymbol(writer, sym);
+    const std::size_t bitCount = writer.bitCount();
+    const std::string bytes = writer.finish();
+
+    huffman::BitReader reader(bytes, bitCount);
+    for (std::uint32_t sym : {3u, 0u, 1u, 2u, 0u}) {
+        ASSERT_EQ(kSmallCode.decodeSymbol(reader), sym);
+    }
+    ASSERT_THROW(static_cast<void>(kSmallCode.decodeSymbol(reader)), std::runtime_error);
+    ASSERT_THROW(kSmallCode.writeSymbol(writer, 4), std::runtime_error);
+}
+
+TEST(test_static_code_rejects_bad_lengths) {
+    using Table = huffman::StaticCodeTable<4, 3>;
+    ASSERT_THROW(Table(std::array<std::uint8_t, 4>{1, 1, 1, 0}), std::invalid_argument);
+    ASSERT_THROW(Table(std::array<std::uint8_t, 4>{1, 4, 0, 0}), std::invalid_argument);
+    ASSERT_THROW(Table(std::array<std::uint8_t, 4>{0, 0, 0, 0}), std::invalid_argument);
+}
+
+TEST(test_static_code_corrupt_input_throws) {
+    const auto packed = huffman::kHeaderTextCode.encode(kHeaders);
+    ASSERT_THROW(static_cast<void>(huffman::kHeaderTextCode.decode(
+                     packed.bytes, packed.bitCount - 3, packed.symbolCount)),
+                 std::runtime_error);
+    ASSERT_THROW(static_cast<void>(huffman::kHeaderTextCode.decode(
+                     packed.bytes, packed.bitCount, packed.symbolCount - 1)),
+                 std::runtime_error);
+
+    // An under-full code leaves indices that match nothing
+    constexpr huffman::StaticCodeTable<256, 2> sparse{[] {
+        std::array<std::uint8_t, 256> lengths{};
+        lengths['a'] = 1;
+        lengths['b'] = 2;
+        return lengths;
+    }()};
+    const std::string ones(1, '\xFF');
+    ASSERT_THROW(static_cast<void>(sparse.decode(ones, 8, 4)), std::runtime_error);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Static Code Unit Tests ===\n\n";
+
+    RUN_TEST(test_static_code_matches_runtime_code_table);
+    RUN_TEST(test_static_code_roundtrip);
+    RUN_TEST(test_static_code_small_alphabet);
+    RUN_TEST(test_static_code_rejects_bad_lengths);
+    RUN_TEST(test_static_code_corrupt_input_throws);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include "stats.h"
+#include "stream.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string sampleText(std::size_t size) {
+    static const char* const words[] = {"alpha ", "beta ", "gamma ", "delta ", "\n"};
+    std::mt19937 rng(3);
+    std::string text;
+    while (text.size() < size) {
+        text += words[rng() % 5];
+    }
+    text.resize(size);
+    return text;
+}
+
+std::string randomBytes(std::size_t size) {
+    std::mt19937 rng(4);
+    std::string bytes(size, '\0');
+    for (char& c : bytes) {
+        c = static_cast<char>(rng());
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(test_stats_encoder_counts) {
+    huffman::StreamOptions options;
+    options.blockSize = 4096;
+    options.blockIndex = true;
+    const huffman::StreamEncoder encoder(options);
+    // Four text blocks with the same statistics, then four random ones
+    const std::string input = sampleText(4 * 4096) + randomBytes(4 * 4096);
+    const std::string stream = encoder.encode(input);
+    const huffman::Stats stats = encoder.stats();
+
+    if constexpr (!huffman::kStatsEnabled) {
+        ASSERT_EQ(stats.bytesIn, 0u);
+        ASSERT_EQ(stats.blocks, 0u);
+        ASSERT_EQ(stats.encodeNs, 0u);
+        return;
+    }
+    ASSERT_EQ(stats.bytesIn, input.size());
+    ASSERT_EQ(stats.bytesOut, stream.size());
+    ASSERT_EQ(stats.blocks, 8u);
+    ASSERT_EQ(stats.tablesBuilt + stats.tablesReused + stats.storedBlocks, 8u);
+    ASSERT_EQ(stats.storedBlocks, 4u);
+    ASSERT_TRUE(stats.tablesReused >= 1);
+    ASSERT_TRUE(stats.histogramNs > 0 && stats.buildNs > 0 && stats.encodeNs > 0);
+    ASSERT_EQ(stats.decodeNs, 0u);
+}
+
+TEST(test_stats_histogram_stage_with_other_models) {
+    huffman::StreamOptions options;
+    options.blockSize = 4096;
+    options.contextTables = 4;
+    options.runLength = true;
+    const huffman::StreamEncoder encoder(options);
+    static_cast<void>(encoder.encode(sampleText(3 * 4096)));
+    const huffman::Stats stats = encoder.stats();
+
+    if constexpr (huffman::kStatsEnabled) {
+        ASSERT_TRUE(stats.histogramNs > 0 && stats.buildNs > 0);
+    } else {
+        ASSERT_EQ(stats.histogramNs, 0u);
+    }
+}
+
+TEST(test_stats_decoder_counts_and_reset) {
+    const huffman::StreamEncoder encoder({1024});
+    const std::string input = sampleText(10000);
+    const std::string stream = encoder.encode(input);
+    const huffman::StreamDecoder decoder(2);
+    ASSERT_TRUE(decoder.decode(stream) == input);
+    ASSERT_TRUE(decoder.decode(stream) == input);
+
+    huffman::StreamDecoder copy = decoder;
+    copy.resetStats();
+    ASSERT_EQ(copy.stats().blocks, 0u);
+
+    const huffman::Stats stats = decoder.stats();
+    if constexpr (!huffman::kStatsEnabled) {
+        ASSERT_EQ(stats.bytesOut, 0u);
+        return;
+    }
+    ASSERT_EQ(stats.bytesIn, 2 * stream.size());
+    ASSERT_EQ(stats.bytesOut, 2 * input.size());
+    ASSERT_EQ(stats.blocks, 20u);
+    ASSERT_EQ(stats.tablesBuilt + stats.tablesReused + stats.storedBlocks, 20u);
+    ASSERT_TRUE(stats.decodeNs > 0);
+    ASSERT_EQ(stats.encodeNs, 0u);
+}
+
+TEST(test_stats_sum_and_json) {
+    huffman::Stats a;
+    a.bytesIn = 10;
+    a.tablesReused = 2;
+    huffman::Stats b;
+    b.bytesIn = 5;
+    b.decodeNs = 7;
+    a += b;
+    ASSERT_EQ(a.bytesIn, 15u);
+    ASSERT_EQ(a.decodeNs, 7u);
+
+    const std::string json = a.toJson();
+    ASSERT_TRUE(json.front() == '{' && json.back() == '}');
+    ASSERT_TRUE(json.find("\"bytes_in\":15,") != std::string::npos);
+    ASSERT_TRUE(json.find("\"tables_reused\":2,") != std::string::npos);
+    ASSERT_TRUE(json.find("\"decode_ns\":7}") != std::string::npos);
+    ASSERT_TRUE(json.find(huffman::kStatsEnabled ? "\"enabled\":true" : "\"enabled\":false") !=
+                std::string::npos);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Stats Unit Tests ===\n\n";
+
+    RUN_TEST(test_stats_encoder_counts);
+    RUN_TEST(test_stats_histogram_stage_with_other_models);
+    RUN_TEST(test_stats_decoder_counts_and_reset);
+    RUN_TEST(test_stats_sum_and_json);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+#include "byte_io.h"
+#include "stream.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::string sampleText(std::size_t size) {
+    const std::string words[] = {"GET ", "/index.html ", "200 ", "404 ", "user=", "42\n",
+                                 "the ", "quick ", "brown ", "fox "};
+    std::mt19937 rng(3);
+    std::string text;
+    while (text.size() < size) {
+        text += words[rng() % 10];
+    }
+    text.resize(size);
+    return text;
+}
+
+} // namespace
+
+TEST(test_stream_roundtrip_multiple_blocks) {
+    std::string input = sampleText(100000);
+    huffman::StreamEncoder encoder({16384, 0});
+    huffman::StreamDecoder decoder(4);
+
+    std::string stream = encoder.encode(input);
+    ASSERT_TRUE(stream.size() < input.size());
+    ASSERT_EQ(decoder.decode(stream), input);
+}
+
+TEST(test_stream_sync_points_split_block) {
+    std::string input = sampleText(250001);
+    huffman::StreamEncoder encoder({1 << 20, 1000});
+    std::string stream = encoder.encode(input);
+
+    for (unsigned threads : {1u, 3u, 8u}) {
+        huffman::StreamDecoder decoder(threads);
+        ASSERT_EQ(decoder.decode(stream), input);
+    }
+    // The index costs eight bytes per sync point
+    std::string plain = huffman::StreamEncoder({1 << 20, 0}).encode(input);
+    ASSERT_EQ(stream.size(), plain.size() + 8 * ((input.size() - 1) / 1000));
+}
+
+TEST(test_stream_without_index_decodes_speculatively) {
+    std::string input = sampleText(400000);
+    std::string stream = huffman::StreamEncoder({1 << 20, 0}).encode(input);
+
+    for (unsigned threads : {2u, 6u}) {
+        huffman::StreamDecoder decoder(threads);
+        ASSERT_EQ(decoder.decode(stream), input);
+    }
+}
+
+TEST(test_stream_read_at_with_index) {
+    std::string input = sampleText(300000);
+    huffman::StreamOptions options;
+    options.blockSize = 65536;
+    options.syncInterval = 4096;
+    options.blockIndex = true;
+    std::string stream = huffman::StreamEncoder(options).encode(input);
+    huffman::StreamDecoder decoder(2);
+
+    ASSERT_EQ(decoder.decode(stream), input);
+    const std::size_t ranges[][2] = {{0, 10}, {65530, 20}, {70000, 5000}, {0, 300000},
+                                     {299990, 10}, {131072, 0}, {4095, 4098}};
+    for (const auto& range : ranges) {
+        ASSERT_EQ(decoder.readAt(stream, range[0], range[1]), input.substr(range[0], range[1]));
+    }
+    ASSERT_THROW(decoder.readAt(stream, 299990, 11), std::invalid_argument);
+}
+
+TEST(test_stream_read_at_without_index) {
+    std::string input = sampleText(50000);
+    std::string stream = huffman::StreamEncoder({8192, 0}).encode(input);
+    huffman::StreamDecoder decoder;
+
+    ASSERT_EQ(decoder.readAt(stream, 8000, 9000), input.substr(8000, 9000));
+    ASSERT_EQ(decoder.readAt(stream, 49999, 1), input.substr(49999, 1));
+}
+
+TEST(test_stream_corrupt_index_throws) {
+    huffman::StreamOptions options;
+    options.blockIndex = true;
+    std::string stream = huffman::StreamEncoder(options).encode("hello world");
+    stream[stream.size() - 1] = 'Y';
+
+    huffman::StreamDecoder decoder;
+    ASSERT_THROW(decoder.decode(stream), std::runtime_error);
+    ASSERT_THROW(decoder.readAt(stream, 1, 2), std::runtime_error);
+}
+
+TEST(test_stream_repeat_of_empty_block_throws) {
+    // A Huffman block with no symbols, then a block repeating its table
+    std::string stream = "HUFS";
+    huffman::appendU8(stream, 2);
+    huffman::appendU8(stream, 0);
+    huffman::appendU32(stream, 16);
+    huffman::appendU64(stream, 2);
+    huffman::appendU32(stream, 2);
+
+    huffman::appendU8(stream, static_cast<std::uint8_t>(huffman::BlockType::Huffman));
+    huffman::appendU32(stream, 0);
+    std::string lengths(256, '\0');
+    lengths['a'] = 1;
+    lengths['b'] = 1;
+    stream += lengths;
+    huffman::appendU64(stream, 0);
+    huffman::appendU32(stream, 0);
+    huffman::appendU32(stream, 0);
+
+    huffman::appendU8(stream, static_cast<std::uint8_t>(huffman::BlockType::RepeatHuffman));
+    huffman::appendU32(stream, 2);
+    huffman::appendU64(stream, 2);
+    huffman::appendU32(stream, 0);
+    huffman::appendU32(stream, 0);
+    huffman::appendU8(stream, 0x02);
+
+    ASSERT_THROW(huffman::StreamDecoder(1).decode(stream), std::runtime_error);
+    ASSERT_THROW(huffman::StreamDecoder(4).decode(stream), std::runtime_error);
+}
+
+TEST(test_stream_empty_and_single_character) {
+    huffman::StreamEncoder encoder({4, 2});
+    huffman::StreamDecoder decoder;
+
+    ASSERT_EQ(decoder.decode(encoder.encode("")), "");
+    ASSERT_EQ(decoder.decode(encoder.encode("aaaaaaaaa")), "aaaaaaaaa");
+}
+
+TEST(test_stream_corrupt_input_throws) {
+    huffman::StreamDecoder decoder;
+    std::string stream = huffman::StreamEncoder().encode("hello world");
+
+    ASSERT_THROW(decoder.decode("XXXX"), std::runtime_error);
+    ASSERT_THROW(decoder.decode(stream.substr(0, stream.size() - 1)), std::runtime_error);
+    ASSERT_THROW(decoder.decode(stream + "x"), std::runtime_error);
+}
+
+TEST(test_stream_incompressible_blocks_are_stored) {
+    std::mt19937 rng(21);
+    std::string random(200000, '\0');
+    for (auto& ch : random) ch = static_cast<char>(rng());
+    const std::string input = random + sampleText(100000);
+
+    huffman::StreamOptions options;
+    options.blockSize = 50000;
+    options.blockIndex = true;
+    const std::string stream = huffman::StreamEncoder(options).encode(input);
+    // Random blocks cost only their headers; text blocks still compress
+    ASSERT_TRUE(stream.size() < random.size() + 100000 * 6 / 10);
+
+    huffman::StreamDecoder decoder(2);
+    ASSERT_EQ(decoder.decode(stream), input);
+    ASSERT_EQ(decoder.readAt(stream, 149990, 100), input.substr(149990, 100));
+    ASSERT_EQ(decoder.readAt(stream, 190000, 20000), input.substr(190000, 20000));
+}
+
+TEST(test_stream_reuses_tables_across_blocks) {
+    // Similar blocks, then a block with bytes the earlier tables lack
+    const std::string input = sampleText(200000) + std::string(3000, '~') + "{}|" + sampleText(60000);
+
+    huffman::StreamOptions options;
+    options.blockSize = 8192;
+    options.syncInterval = 1000;
+    options.blockIndex = true;
+    const std::string reused = huffman::StreamEncoder(options).encode(input);
+    options.reuseTables = false;
+    const std::string fresh = huffman::StreamEncoder(options).encode(input);
+    ASSERT_TRUE(reused.size() + 20 * 256 < fresh.size());
+
+    huffman::StreamDecoder decoder(3);
+    ASSERT_EQ(decoder.decode(reused), input);
+    ASSERT_EQ(decoder.readAt(reused, 150000, 2000), input.substr(150000, 2000));
+    ASSERT_EQ(decoder.readAt(reused, 240000, 9000), input.substr(240000, 9000));
+
+    options.blockIndex = false;
+    options.reuseTables = true;
+    const std::string noIndex = huffman::StreamEncoder(options).encode(input);
+    ASSERT_EQ(decoder.readAt(noIndex, 100000, 30000), input.substr(100000, 30000));
+}
+
+TEST(test_stream_reuses_tables_for_small_blocks) {
+    // Blocks this small never pay for their own table, only for a repeat
+    const std::string input = sampleText(64 << 10);
+    huffman::StreamOptions options;
+    options.blockSize = 256;
+    const huffman::StreamEncoder reusing(options);
+    const std::string reused = reusing.encode(input);
+    options.reuseTables = false;
+    const std::string fresh = huffman::StreamEncoder(options).encode(input);
+    ASSERT_TRUE(reused.size() < input.size());
+    ASSERT_TRUE(reused.size() < fresh.size());
+    ASSERT_EQ(huffman::StreamDecoder(2).decode(reused), input);
+    if constexpr (huffman::kStatsEnabled) {
+        ASSERT_TRUE(reusing.stats().tablesReused > 200);
+    }
+}
+
+TEST(test_stream_invalid_options_throw) {
+    ASSERT_THROW(huffman::StreamEncoder({0, 0}), std::invalid_argument);
+}
+
+TEST(test_stream_bound_and_decode_into_caller_buffer) {
+    std::mt19937 rng(11);
+    std::string random(70000, '\0');
+    for (char& c : random) c = static_cast<char>(rng());
+
+    huffman::StreamOptions options;
+    options.blockSize = 8192;
+    options.syncInterval = 512;
+    options.blockIndex = true;
+    for (const std::string& input : {random, sampleText(70000), std::string()}) {
+        const huffman::StreamEncoder encoder(options);
+        const std::string stream = encoder.encode(input);
+        ASSERT_TRUE(stream.size() <= encoder.maxEncodedSize(input.size()));
+        ASSERT_EQ(huffman::StreamDecoder::decodedSize(stream), input.size());
+
+        // Appends after existing content, and decodes in place
+        std::string buffer = "prefix";
+        encoder.encodeTo(buffer, input);
+        ASSERT_EQ(buffer.substr(6), stream);
+
+        // Encodes straight into caller memory given the bound, and only then
+        const std::size_t bound = encoder.maxEncodedSize(input.size());
+        std::string direct(bound, '\0');
+        ASSERT_EQ(encoder.encodeInto(input, direct.data(), bound), stream.size());
+        ASSERT_EQ(direct.substr(0, stream.size()), stream);
+        ASSERT_THROW(static_cast<void>(encoder.encodeInto(input, direct.data(), bound - 1)),
+                     std::invalid_argument);
+
+        std::string out(input.size() + 3, '#');
+        ASSERT_EQ(huffman::StreamDecoder(2).decodeInto(stream, out.data(), out.size()), input.size());
+        ASSERT_EQ(out.substr(0, input.size()), input);
+        ASSERT_EQ(out.substr(input.size()), "###");
+        if (!input.empty()) {
+            ASSERT_THROW(huffman::StreamDecoder(1).decodeInto(stream, out.data(), input.size() - 1),
+                         std::invalid_argument);
+        }
+    }
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Stream Unit Tests ===\n\n";
+
+    RUN_TEST(test_stream_roundtrip_multiple_blocks);
+    RUN_TEST(test_stream_sync_points_split_block);
+    RUN_TEST(test_stream_without_index_decodes_speculatively);
+    RUN_TEST(test_stream_read_at_with_index);
+    RUN_TEST(test_stream_read_at_without_index);
+    RUN_TEST(test_stream_corrupt_index_throws);
+    RUN_TEST(test_stream_empty_and_single_character);
+    RUN_TEST(test_stream_corrupt_input_throws);
+    RUN_TEST(test_stream_repeat_of_empty_block_throws);
+    RUN_TEST(test_stream_incompressible_blocks_are_stored);
+    RUN_TEST(test_stream_reuses_tables_across_blocks);
+    RUN_TEST(test_stream_reuses_tables_for_small_blocks);
+    RUN_TEST(test_stream_invalid_options_throw);
+    RUN_TEST(test_stream_bound_and_decode_into_caller_buffer);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#include "code_table.h"
+#include "huffman.h"
+#include "speculative_decoder.h"
+#include "table_decoder.h"
+#include "test_common.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+huffman::CodeTable tableFor(const std::string& input) {
+    huffman::HuffmanTree tree;
+    tree.buildTree(input);
+    return huffman::CodeTable::fromTree(tree);
+}
+
+// Fibonacci frequencies produce a maximally deep tree
+std::string fibonacciText(int symbols) {
+    std::string text;
+    long a = 1, b = 1;
+    for (int i = 0; i < symbols; ++i) {
+        text.append(static_cast<std::size_t>(a), static_cast<char>('A' + i));
+        long next = a + b;
+        a = b;
+        b = next;
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(test_packed_roundtrip_single_symbol_entries) {
+    std::string input = "The quick brown fox jumps over the lazy dog. 0123456789";
+    auto table = tableFor(input);
+    huffman::TableDecoder decoder(table, {11, 1});
+
+    auto packed = table.encode(input);
+    ASSERT_EQ(packed.symbolCount, input.size());
+    ASSERT_EQ(decoder.decode(packed), input);
+}
+
+TEST(test_packed_roundtrip_multi_symbol_entries) {
+    std::string input;
+    for (int i = 0; i < 500; ++i) {
+        input += "aaaabaaacaabaaaaadaaaaaaa 127.0.0.1 GET /index.html 200\n";
+    }
+    auto table = tableFor(input);
+    huffman::TableDecoder decoder(table);
+    ASSERT_EQ(decoder.maxSymbolsPerEntry(), 4u);
+
+    auto packed = table.encode(input);
+    ASSERT_TRUE(packed.bitCount < input.size() * 8);
+    ASSERT_EQ(decoder.decode(packed), input);
+}
+
+TEST(test_packed_single_character) {
+    std::string input = "aaaa";
+    auto table = tableFor(input);
+    huffman::TableDecoder decoder(table);
+
+    auto packed = table.encode(input);
+    ASSERT_EQ(packed.bitCount, 4u);
+    ASSERT_EQ(decoder.decode(packed), input);
+}
+
+TEST(test_long_codes_are_limited) {
+    std::string input = fibonacciText(22);
+    auto table = tableFor(input);
+    ASSERT_TRUE(table.maxLength() <= huffman::CodeTable::kMaxCodeLength);
+
+    // Codes longer than the index fall back to canonical resolution
+    huffman::TableDecoder decoder(table, {8, 4});
+    ASSERT_EQ(decoder.decode(table.encode(input)), input);
+}
+
+TEST(test_decode_kernels_agree) {
+    std::string input = fibonacciText(18) + "The quick brown fox jumps over the lazy dog.";
+    auto table = tableFor(input);
+    huffman::TableDecoder decoder(table, {9, 4});
+    auto packed = table.encode(input);
+
+    for (auto kernel : {huffman::DecodeKernel::Generic, huffman::DecodeKernel::Bmi2}) {
+        if (!huffman::isKernelSupported(kernel)) continue;
+        ASSERT_EQ(decoder.decode(packed.bytes, packed.bitCount, packed.symbolCount, kernel), input);
+    }
+    ASSERT_TRUE(huffman::isKernelSupported(huffman::detectDecodeKernel()));
+}
+
+TEST(test_speculative_decode_matches_sequential) {
+    std::string input;
+    for (int i = 0; i < 20000; ++i) {
+        input += "GET /api/v1/items?id=" + std::to_string(i * 7919 % 100003) + " 200\n";
+    }
+    auto table = tableFor(input);
+    auto packed = table.encode(input);
+    ASSERT_TRUE(packed.bitCount > 8 * huffman::kSpeculativeMinChunkBits);
+
+    for (unsigned symbols : {1u, 4u}) {
+        huffman::TableDecoder decoder(table, {11, symbols});
+        for (unsigned threads : {1u, 2u, 5u, 8u}) {
+            ASSERT_EQ(huffman::decodeSpeculative(decoder, packed.bytes, packed.bitCount,
+                                                 packed.symbolCount, threads), input);
+        }
+    }
+}
+
+TEST(test_speculative_decode_corrupt_throws) {
+    std::string input = fibonacciText(14);
+    while (input.size() < 200000) input += input;
+    auto table = tableFor(input);
+    huffman::TableDecoder decoder(table);
+    auto packed = table.encode(input);
+
+    ASSERT_THROW(huffman::decodeSpeculative(decoder, packed.bytes, packed.bitCount,
+                                            packed.symbolCount - 1, 4), std::runtime_error);
+}
+
+TEST(test_speculative_decode_recovers_misaligned_chunks) {
+    // An incomplete 2-bit code: chunks starting at odd bits decode "11", which
+    // has no symbol, and must be re-decoded from the true boundary
+    const huffman::CodeTable table(std::vector<std::uint8_t>{2, 2, 2});
+    std::string input(400001, '\0');
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<char>(i % 3);
+    }
+    auto packed = table.encode(input);
+    ASSERT_TRUE((packed.bitCount / 3) % 2 == 1);
+
+    huffman::TableDecoder decoder(table);
+    ASSERT_EQ(huffman::decodeSpeculative(decoder, packed.bytes, packed.bitCount,
+                                         packed.symbolCount, 3), input);
+}
+
+TEST(test_oversubscribed_lengths_throw) {
+    std::vector<std::uint8_t> lengths = {1, 1, 1};
+    ASSERT_THROW(huffman::CodeTable(lengths), std::invalid_argument);
+}
+
+TEST(test_packed_decode_truncated_throws) {
+    std::string input = "abcabcabd";
+    auto table = tableFor(input);
+    huffman::TableDecoder decoder(table);
+
+    auto packed = table.encode(input);
+    ASSERT_THROW(decoder.decode(packed.bytes, packed.bitCount - 1, packed.symbolCount),
+                 std::runtime_error);
+    ASSERT_THROW(decoder.decode(packed.bytes, packed.bitCount, packed.symbolCount - 1),
+                 std::runtime_error);
+}
+
+int main() {
+    int passed = 0;
+    int failed = 0;
+
+    std::cout << "=== Table Decoder Unit Tests ===\n\n";
+
+    RUN_TEST(test_packed_roundtrip_single_symbol_entries);
+    RUN_TEST(test_packed_roundtrip_multi_symbol_entries);
+    RUN_TEST(test_packed_single_character);
+    RUN_TEST(test_long_codes_are_limited);
+    RUN_TEST(test_decode_kernels_agree);
+    RUN_TEST(test_speculative_decode_matches_sequential);
+    RUN_TEST(test_speculative_decode_corrupt_throws);
+    RUN_TEST(test_speculative_decode_recovers_misaligned_chunks);
+    RUN_TEST(test_oversubscribed_lengths_throw);
+    RUN_TEST(test_packed_decode_truncated_throws);
+
+    std::cout << "\n=== Results ===\n";
+    std::cout << "Passed: " << passed << '\n';
+    std::cout << "Failed: " << failed << '\n';
+
+    return failed == 0 ? 0 : 1;
+}